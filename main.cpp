@@ -20,6 +20,7 @@
 #include <instanced_model/instanced_model.hpp>
 #include <car_model/car_model.hpp>
 #include <skybox/skybox.hpp>
+#include <world/world.hpp>
 
 // Configured by CMake
 #include <config_application_out.hpp>
@@ -44,6 +45,7 @@ int main(int argc, char** argv) try {
     auto window_config = config_handler.GetWindowConfig();
 	auto collision_intersector_config = config_handler.GetCollisionIntersectorConfig();
 	auto ray_intersector_config = config_handler.GetRayIntersectorConfig();
+    auto lidar_config = config_handler.GetLidarConfig();
     auto camera_config = config_handler.GetCameraConfig();
 
     context.projection_matrix = GL::Mat4::Perspective(
@@ -62,15 +64,21 @@ int main(int argc, char** argv) try {
     gl.BlendFunc(GL::BlendingFactor::SourceAlpha, GL::BlendingFactor::OneMinusSourceAlpha);
 
     context.camera = App::Camera(camera_config);
-    context.car_model->SetCollisionIntersector(collision_intersector_config);
-    context.car_model->SetRayIntersector(ray_intersector_config);
+
+    App::World world{};
+    config_handler.LoadWorld(world);
+    world.car_model->SetCollisionIntersector(collision_intersector_config);
+    world.car_model->SetRayIntersector(ray_intersector_config);
+    if (lidar_config.enabled) {
+        world.car_model->SetLidar(lidar_config);
+    }
     App::Gui gui(window_config);
 
     App::Timer main_timer;
     main_timer.Start();
 
     // NN stuff
-    AppNN::Trainer nn_trainer;
+    AppNN::Trainer nn_trainer{world};
 
     bool space_was_pressed = false;
     bool draw_gui = true;
@@ -100,39 +108,26 @@ int main(int argc, char** argv) try {
             }
         }
 
-        // FIX THIS PART
-        auto car_collision_intersector = context.car_model->GetCollisionIntersector();
-        auto car_ray_intersector = context.car_model->GetRayIntersector();
-
-        if (car_collision_intersector) {
-            car_collision_intersector->ClearObstacles();
-
-            for (auto obstacle : context.obstacles) {
-                car_collision_intersector->AddObstacles(obstacle.get());
-            }
-        }
-        if (car_ray_intersector) {
-            car_ray_intersector->ClearObstacles();
-
-            for (auto obstacle : context.obstacles) {
-                car_ray_intersector->AddObstacles(obstacle.get());
-            }
-        }
-        // FIX THIS PART
-
         context.camera->Move(delta_time);
         if (context.keyboard_mode.value() == App::KeyboardMode::NN_LEARNING) {
             nn_trainer.TrainingStep(delta_time);
         } else if (context.keyboard_mode.value() == App::KeyboardMode::NN_TEST) {
             nn_trainer.TrainingStep(delta_time);
         } else {
-            context.car_model->Move(delta_time);
+            world.actions = App::GetKeyboardActions(context.keyboard_status.value());
+            world.Step(delta_time);
+        }
+
+        // If the car is moving - keep updating the camera
+        // If the car is still - update the camera only in case there was a collision
+        if ((world.car_model->GetSpeed() != 0.0f) || (world.car_model->WasStopped() && !context.camera->ReachedFinalPosition())) {
+            context.camera->UpdateWithModel(world.car_model->GetModelMatrix());
         }
 
-        // for (int model_index = 0; model_index < context.obstacles.size(); ++model_index) {
+        // for (int model_index = 0; model_index < world.obstacles.size(); ++model_index) {
         //     auto intersection_result = car_collision_intersector->GetIntersectedObstacleMeshIndices(model_index);
         //     for (auto mesh_index : intersection_result) {
-        //         context.obstacles[model_index]->DrawBBoxOnCollision(mesh_index);
+        //         world.obstacles[model_index]->DrawBBoxOnCollision(mesh_index);
         //     }
         // }
 
@@ -141,17 +136,17 @@ int main(int argc, char** argv) try {
             gui.Prepare();
         }
 
-        context.car_model->Draw();
+        world.car_model->Draw();
         context.skybox->Draw();
         for (auto env_object : context.env) {
             env_object->Draw();
         }
-        for (auto obstacle : context.obstacles) {
+        for (auto obstacle : world.obstacles) {
             obstacle->Draw();
         }
 
         if (draw_gui) {
-            gui.Draw();
+            gui.Draw(world);
         }
 
         context.camera->UpdateMatrix();
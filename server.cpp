@@ -0,0 +1,69 @@
+// Windows defines for PyTorch
+#define NOMINMAX
+
+// LibSmartCar
+#include <helpers/helpers.hpp>
+#include <camera/camera.hpp>
+#include <config/config_handler.hpp>
+#include <car_model/car_model.hpp>
+#include <world/world.hpp>
+#include <env_server/env_server.hpp>
+
+// Configured by CMake
+#include <config_application_out.hpp>
+
+/*
+    Headless entry point for external trainers: the window is created
+    only to get the GL context for the intersectors, nothing is drawn
+*/
+int main(int argc, char** argv) try {
+    auto& context = App::Context::Get();
+    context.keyboard_mode = App::KeyboardMode::NN_TEST;
+    context.keyboard_status = App::KeyboardStatus{};
+    context.keyboard_status->fill(false);
+
+    if (argc != 2) {
+        throw std::runtime_error("Wrong number of arguments!\nUsage: ./SmartCarServer.exe <config file path>");
+    }
+    App::ConfigHandler config_handler{argv[1], APP_CONFIG_DIR};
+
+    auto collision_intersector_config = config_handler.GetCollisionIntersectorConfig();
+    auto ray_intersector_config = config_handler.GetRayIntersectorConfig();
+    auto lidar_config = config_handler.GetLidarConfig();
+    auto server_config = config_handler.GetServerConfig();
+
+    context.camera = App::Camera(config_handler.GetCameraConfig());
+
+    /*
+        Every environment gets its own world with its own car. Obstacles of all the worlds come from
+        the same config and never move, so they are loaded once by the first world, the other cars share its registry
+        and the server traces the rays of the whole batch at once
+    */
+    std::vector<std::unique_ptr<App::World>> worlds;
+    worlds.reserve(server_config.environments_count);
+    for (int world_index = 0; world_index < server_config.environments_count; ++world_index) {
+        auto world = std::make_unique<App::World>();
+        if (world_index == 0) {
+            config_handler.LoadWorld(*world);
+        } else {
+            world->obstacles = worlds[0]->obstacles;
+            world->obstacle_registry = worlds[0]->obstacle_registry;
+            config_handler.LoadCar(*world);
+        }
+        world->car_model->SetCollisionIntersector(collision_intersector_config);
+        world->car_model->SetRayIntersector(ray_intersector_config);
+        if (lidar_config.enabled) {
+            world->car_model->SetLidar(lidar_config);
+        }
+        worlds.push_back(std::move(world));
+    }
+
+    AppNN::EnvServer env_server{server_config, std::move(worlds)};
+    env_server.Run();
+
+    return 0;
+}
+catch (std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+}
\ No newline at end of file
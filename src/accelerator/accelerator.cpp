@@ -6,43 +6,36 @@ namespace App {
 extern const float APP_CAR_SPEED_EPS;
 
 Accelerator::Accelerator(const float max_speed, const float acceleration)
-    : max_speed_(max_speed), acceleration_(acceleration), cur_speed_(0.0f), was_stopped_(true) {
+    : max_speed_(max_speed), acceleration_(acceleration) {
     if (acceleration <= 0) {
         throw std::runtime_error("Wrong acceleration value given!");
     }
 }
 
-void Accelerator::IncreaseSpeed(const float delta_time, const bool move_front) {
-    float new_speed = cur_speed_ + (move_front ? 1.0f : -1.0f) * acceleration_ * delta_time;
+const float Accelerator::IncreaseSpeed(const float speed, const float delta_time, const bool move_front) const {
+    float new_speed = speed + (move_front ? 1.0f : -1.0f) * acceleration_ * delta_time;
     if ((new_speed > -1.0f * max_speed_) && (new_speed < max_speed_)) {
-        cur_speed_ = new_speed;
+        return new_speed;
     }
-    was_stopped_ = false;
+    return speed;
 }
 
-void Accelerator::DecreaseSpeed(const float delta_time) {
-    if (std::fabs(cur_speed_) <= APP_CAR_SPEED_EPS) {
-        cur_speed_ = 0.0f;
-        return;
+const float Accelerator::DecreaseSpeed(const float speed, const float delta_time) const {
+    if (std::fabs(speed) <= APP_CAR_SPEED_EPS) {
+        return 0.0f;
     }
-    if (cur_speed_ > 0.0) {
-        cur_speed_ -= acceleration_ * delta_time;
-    } else {
-        cur_speed_ += acceleration_ * delta_time;
+    if (speed > 0.0) {
+        return speed - acceleration_ * delta_time;
     }
+    return speed + acceleration_ * delta_time;
 }
 
-void Accelerator::Stop() {
-    cur_speed_ = 0.0f;
-    was_stopped_ = true;
+const float Accelerator::GetMaxSpeed() const {
+    return max_speed_;
 }
 
-const float Accelerator::GetSpeed() const {
-    return cur_speed_;
-}
-
-const bool Accelerator::WasStopped() const {
-    return was_stopped_;
+const float Accelerator::GetAcceleration() const {
+    return acceleration_;
 }
 
 } // namespace App
\ No newline at end of file
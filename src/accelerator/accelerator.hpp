@@ -13,24 +13,22 @@
 
 namespace App {
 
+/*
+    Speed model of the car, it keeps no state
+    of its own: the speed is stored in CarState
+*/
 class Accelerator {
 public:
     Accelerator(const float max_speed, const float acceleration);
 
-    void IncreaseSpeed(const float delta_time, const bool move_front);
-    void DecreaseSpeed(const float delta_time);
-    void Stop();
-    const float GetSpeed() const;
-    const bool WasStopped() const;
+    const float IncreaseSpeed(const float speed, const float delta_time, const bool move_front) const;
+    const float DecreaseSpeed(const float speed, const float delta_time) const;
+    const float GetMaxSpeed() const;
+    const float GetAcceleration() const;
 
 private:
-    const float max_speed_;
-    const float acceleration_;
-
-    float cur_speed_;
-
-    // Check if car was stopped by collision
-    bool was_stopped_; 
+    float max_speed_;
+    float acceleration_;
 
     friend class Gui; // access to private variables
 };
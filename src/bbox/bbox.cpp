@@ -132,7 +132,7 @@ void BBox::Draw(const bool is_wireframe) const {
 }
 
 const MemoryAlignedBBox BBox::GetMABB() const {
-    return MemoryAlignedBBox{cur_min_, cur_max_, GL::Mat4{}, GL::Mat4{}};
+    return MemoryAlignedBBox{init_min_, init_max_, GL::Mat4{}, GL::Mat4{}};
 }
 
 } // namespace App
\ No newline at end of file
@@ -27,6 +27,7 @@ public:
 
     void UpdateVertices(const Transform& mesh_self_transform);
     void Draw(const bool is_wireframe) const;
+    // Bounds before the mesh self transform, which is a part of mesh_to_model set by the mesh
     const MemoryAlignedBBox GetMABB() const;
 
     void Enable() { is_enabled_ = true; }
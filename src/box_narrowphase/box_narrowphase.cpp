@@ -0,0 +1,257 @@
+#include "box_narrowphase.hpp"
+
+// LibSmartCar
+#include <simd/simd.hpp>
+
+namespace App {
+
+// Extern variables
+extern const float APP_INTERSECTOR_SAT_PARALLEL_EPS;
+
+OrientedBox GetOrientedBox(const MemoryAlignedBBox& bbox) {
+    GL::Mat4 mesh_to_world = bbox.model * bbox.mesh_to_model;
+    GL::Vec3 center = mesh_to_world * GL::Vec3{
+        0.5f * (bbox.min_point.X + bbox.max_point.X),
+        0.5f * (bbox.min_point.Y + bbox.max_point.Y),
+        0.5f * (bbox.min_point.Z + bbox.max_point.Z)
+    };
+    const float mesh_half_sizes[3] = {
+        0.5f * (bbox.max_point.X - bbox.min_point.X),
+        0.5f * (bbox.max_point.Y - bbox.min_point.Y),
+        0.5f * (bbox.max_point.Z - bbox.min_point.Z)
+    };
+
+    OrientedBox box{};
+    box.center[0] = center.X;
+    box.center[1] = center.Y;
+    box.center[2] = center.Z;
+    box.is_axis_aligned = true;
+
+    // Columns of the matrix are the mesh axes, their lengths are the scale
+    for (int axis = 0; axis < 3; ++axis) {
+        const float* column = mesh_to_world.m + 4 * axis;
+        float length = std::sqrt(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]);
+        for (int component = 0; component < 3; ++component) {
+            box.axes[axis][component] = (length > 0.0f) ? column[component] / length : ((component == axis) ? 1.0f : 0.0f);
+        }
+        box.half_sizes[axis] = mesh_half_sizes[axis] * length;
+        box.is_axis_aligned = box.is_axis_aligned && (std::fabs(box.axes[axis][axis]) == 1.0f);
+    }
+    return box;
+}
+
+void OrientedBoxes::Clear() {
+    for (auto* component : {&center_x, &center_y, &center_z, &half_size_x, &half_size_y, &half_size_z, &rotation_x, &rotation_y, &rotation_z, &rotation_w}) {
+        component->clear();
+    }
+    is_axis_aligned.clear();
+}
+
+void OrientedBoxes::Add(const OrientedBox& box) {
+    for (auto* component : {&center_x, &center_y, &center_z, &half_size_x, &half_size_y, &half_size_z, &rotation_x, &rotation_y, &rotation_z, &rotation_w}) {
+        component->push_back(0.0f);
+    }
+    is_axis_aligned.push_back(0);
+    Set(GetSize() - 1, box);
+}
+
+void OrientedBoxes::Set(const size_t index, const OrientedBox& box) {
+    center_x[index] = box.center[0];
+    center_y[index] = box.center[1];
+    center_z[index] = box.center[2];
+    half_size_x[index] = box.half_sizes[0];
+    half_size_y[index] = box.half_sizes[1];
+    half_size_z[index] = box.half_sizes[2];
+    is_axis_aligned[index] = box.is_axis_aligned;
+
+    // Rotation matrix has the axes as its columns, a mirrored basis has its last axis flipped to stay a rotation
+    float r[3][3];
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int component = 0; component < 3; ++component) {
+            r[component][axis] = box.axes[axis][component];
+        }
+    }
+    const float determinant = r[0][0] * (r[1][1] * r[2][2] - r[2][1] * r[1][2])
+        - r[0][1] * (r[1][0] * r[2][2] - r[2][0] * r[1][2])
+        + r[0][2] * (r[1][0] * r[2][1] - r[2][0] * r[1][1]);
+    if (determinant < 0.0f) {
+        for (int component = 0; component < 3; ++component) {
+            r[component][2] = -r[component][2];
+        }
+    }
+
+    // Largest of the quaternion components is found first, so the division is stable
+    float q[4]; // x, y, z, w
+    const float trace = r[0][0] + r[1][1] + r[2][2];
+    if (trace > 0.0f) {
+        float s = 2.0f * std::sqrt(trace + 1.0f);
+        q[0] = (r[2][1] - r[1][2]) / s;
+        q[1] = (r[0][2] - r[2][0]) / s;
+        q[2] = (r[1][0] - r[0][1]) / s;
+        q[3] = 0.25f * s;
+    } else if ((r[0][0] > r[1][1]) && (r[0][0] > r[2][2])) {
+        float s = 2.0f * std::sqrt(1.0f + r[0][0] - r[1][1] - r[2][2]);
+        q[0] = 0.25f * s;
+        q[1] = (r[0][1] + r[1][0]) / s;
+        q[2] = (r[0][2] + r[2][0]) / s;
+        q[3] = (r[2][1] - r[1][2]) / s;
+    } else if (r[1][1] > r[2][2]) {
+        float s = 2.0f * std::sqrt(1.0f + r[1][1] - r[0][0] - r[2][2]);
+        q[0] = (r[0][1] + r[1][0]) / s;
+        q[1] = 0.25f * s;
+        q[2] = (r[1][2] + r[2][1]) / s;
+        q[3] = (r[0][2] - r[2][0]) / s;
+    } else {
+        float s = 2.0f * std::sqrt(1.0f + r[2][2] - r[0][0] - r[1][1]);
+        q[0] = (r[0][2] + r[2][0]) / s;
+        q[1] = (r[1][2] + r[2][1]) / s;
+        q[2] = 0.25f * s;
+        q[3] = (r[1][0] - r[0][1]) / s;
+    }
+    const float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    rotation_x[index] = q[0] / length;
+    rotation_y[index] = q[1] / length;
+    rotation_z[index] = q[2] / length;
+    rotation_w[index] = q[3] / length;
+}
+
+void OrientedBoxes::Erase(const size_t first_index, const size_t count) {
+    for (auto* component : {&center_x, &center_y, &center_z, &half_size_x, &half_size_y, &half_size_z, &rotation_x, &rotation_y, &rotation_z, &rotation_w}) {
+        component->erase(component->begin() + first_index, component->begin() + first_index + count);
+    }
+    is_axis_aligned.erase(is_axis_aligned.begin() + first_index, is_axis_aligned.begin() + first_index + count);
+}
+
+OrientedBox OrientedBoxes::Get(const size_t index) const {
+    const float x = rotation_x[index];
+    const float y = rotation_y[index];
+    const float z = rotation_z[index];
+    const float w = rotation_w[index];
+
+    OrientedBox box{
+        {center_x[index], center_y[index], center_z[index]},
+        {
+            {1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w)},
+            {2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w)},
+            {2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y)}
+        },
+        {half_size_x[index], half_size_y[index], half_size_z[index]},
+        is_axis_aligned[index] != 0
+    };
+    return box;
+}
+
+void BoxNarrowphase::Clear() {
+    pairs_count_ = 0;
+    first_indices_.clear();
+    second_indices_.clear();
+}
+
+void BoxNarrowphase::Add(const int first_index, const int second_index) {
+    // Padding lanes test the 0-th boxes and are dropped, so the kernel has no scalar tail
+    if (pairs_count_ % Simd::APP_SIMD_WIDTH == 0) {
+        first_indices_.resize(pairs_count_ + Simd::APP_SIMD_WIDTH, 0);
+        second_indices_.resize(pairs_count_ + Simd::APP_SIMD_WIDTH, 0);
+    }
+    first_indices_[pairs_count_] = first_index;
+    second_indices_[pairs_count_] = second_index;
+    ++pairs_count_;
+}
+
+// Center, half sizes and axes of the boxes of SIMD width pairs, same as OrientedBoxes::Get
+static void GatherBoxes(const OrientedBoxes& boxes, const std::int32_t* indices,
+    Simd::Float* center, Simd::Float* half_sizes, Simd::Float (*axes)[3]) {
+    using namespace Simd;
+
+    center[0] = Gather(boxes.center_x.data(), indices);
+    center[1] = Gather(boxes.center_y.data(), indices);
+    center[2] = Gather(boxes.center_z.data(), indices);
+    half_sizes[0] = Gather(boxes.half_size_x.data(), indices);
+    half_sizes[1] = Gather(boxes.half_size_y.data(), indices);
+    half_sizes[2] = Gather(boxes.half_size_z.data(), indices);
+
+    const Float x = Gather(boxes.rotation_x.data(), indices);
+    const Float y = Gather(boxes.rotation_y.data(), indices);
+    const Float z = Gather(boxes.rotation_z.data(), indices);
+    const Float w = Gather(boxes.rotation_w.data(), indices);
+    const Float one = Broadcast(1.0f);
+    const Float two = Broadcast(2.0f);
+    axes[0][0] = one - two * (y * y + z * z);
+    axes[0][1] = two * (x * y + z * w);
+    axes[0][2] = two * (x * z - y * w);
+    axes[1][0] = two * (x * y - z * w);
+    axes[1][1] = one - two * (x * x + z * z);
+    axes[1][2] = two * (y * z + x * w);
+    axes[2][0] = two * (x * z + y * w);
+    axes[2][1] = two * (y * z - x * w);
+    axes[2][2] = one - two * (x * x + y * y);
+}
+
+void BoxNarrowphase::TestOverlaps(const OrientedBoxes& first_boxes, const OrientedBoxes& second_boxes, std::vector<std::uint8_t>& overlaps) const {
+    using namespace Simd;
+
+    const size_t padded_count = first_indices_.size();
+    overlaps.resize(padded_count);
+    const Float eps = Broadcast(APP_INTERSECTOR_SAT_PARALLEL_EPS);
+
+    for (size_t first_pair = 0; first_pair < padded_count; first_pair += APP_SIMD_WIDTH) {
+        Float first_center[3];
+        Float second_center[3];
+        Float first_axes[3][3];
+        Float second_axes[3][3];
+        Float first_half_sizes[3];
+        Float second_half_sizes[3];
+        GatherBoxes(first_boxes, first_indices_.data() + first_pair, first_center, first_half_sizes, first_axes);
+        GatherBoxes(second_boxes, second_indices_.data() + first_pair, second_center, second_half_sizes, second_axes);
+        Float translation[3];
+        for (int component = 0; component < 3; ++component) {
+            translation[component] = second_center[component] - first_center[component];
+        }
+
+        // Second box and the translation in the frame of the first box
+        Float rotation[3][3];
+        Float abs_rotation[3][3];
+        Float local_translation[3];
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                rotation[i][j] = first_axes[i][0] * second_axes[j][0] + first_axes[i][1] * second_axes[j][1] + first_axes[i][2] * second_axes[j][2];
+                abs_rotation[i][j] = Abs(rotation[i][j]) + eps;
+            }
+            local_translation[i] = translation[0] * first_axes[i][0] + translation[1] * first_axes[i][1] + translation[2] * first_axes[i][2];
+        }
+
+        Mask separated = Broadcast(0.0f) != Broadcast(0.0f);
+
+        // Axes of the first box
+        for (int i = 0; i < 3; ++i) {
+            Float second_radius = second_half_sizes[0] * abs_rotation[i][0] + second_half_sizes[1] * abs_rotation[i][1] + second_half_sizes[2] * abs_rotation[i][2];
+            separated = separated | (Abs(local_translation[i]) > first_half_sizes[i] + second_radius);
+        }
+
+        // Axes of the second box
+        for (int j = 0; j < 3; ++j) {
+            Float first_radius = first_half_sizes[0] * abs_rotation[0][j] + first_half_sizes[1] * abs_rotation[1][j] + first_half_sizes[2] * abs_rotation[2][j];
+            Float distance = local_translation[0] * rotation[0][j] + local_translation[1] * rotation[1][j] + local_translation[2] * rotation[2][j];
+            separated = separated | (Abs(distance) > first_radius + second_half_sizes[j]);
+        }
+
+        // Cross products of the edges
+        for (int i = 0; i < 3; ++i) {
+            int i1 = (i + 1) % 3;
+            int i2 = (i + 2) % 3;
+            for (int j = 0; j < 3; ++j) {
+                int j1 = (j + 1) % 3;
+                int j2 = (j + 2) % 3;
+                Float first_radius = first_half_sizes[i1] * abs_rotation[i2][j] + first_half_sizes[i2] * abs_rotation[i1][j];
+                Float second_radius = second_half_sizes[j1] * abs_rotation[i][j2] + second_half_sizes[j2] * abs_rotation[i][j1];
+                Float distance = local_translation[i2] * rotation[i1][j] - local_translation[i1] * rotation[i2][j];
+                separated = separated | (Abs(distance) > first_radius + second_radius);
+            }
+        }
+
+        StoreMask(overlaps.data() + first_pair, !separated);
+    }
+    overlaps.resize(pairs_count_);
+}
+
+} // namespace App
\ No newline at end of file
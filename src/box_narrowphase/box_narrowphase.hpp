@@ -0,0 +1,88 @@
+#pragma once
+
+// STL
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// OpenGL Wrapper
+#include <GL/OOGL.hpp>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <box_narrowphase/box_narrowphase_fwd.hpp>
+
+// LibSmartCar
+#include <helpers/helpers.hpp>
+
+namespace App {
+
+// World space box given by its center, unit axes and half sizes along them
+struct OrientedBox {
+    float center[3];
+    float axes[3][3];
+    float half_sizes[3];
+    bool is_axis_aligned; // then the world bounds are exact
+};
+
+/*
+    Mesh space box moved into the world.
+    WARNING: transforms are expected to be rotation, scale and translation, sheared axes are not orthogonal anymore
+*/
+OrientedBox GetOrientedBox(const MemoryAlignedBBox& bbox);
+
+/*
+    Oriented boxes stored as structure of arrays: center, half sizes and the rotation as a unit quaternion,
+    10 floats per box instead of 15 of OrientedBox. Mirrored boxes get one axis flipped, the box stays the same
+*/
+struct OrientedBoxes {
+    void Clear();
+    void Add(const OrientedBox& box);
+    void Set(const size_t index, const OrientedBox& box);
+    void Erase(const size_t first_index, const size_t count);
+    size_t GetSize() const { return center_x.size(); }
+
+    // Axes are restored from the quaternion
+    OrientedBox Get(const size_t index) const;
+
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> half_size_x;
+    std::vector<float> half_size_y;
+    std::vector<float> half_size_z;
+    std::vector<float> rotation_x;
+    std::vector<float> rotation_y;
+    std::vector<float> rotation_z;
+    std::vector<float> rotation_w;
+    std::vector<std::uint8_t> is_axis_aligned;
+};
+
+/*
+    Separating axis test of box pairs: 3 axes of every box and 9 cross products of their edges.
+    Only the indices of the pairs are stored, boxes are gathered from the OrientedBoxes arrays
+    and their axes are restored from the quaternions in registers, so one SIMD instruction tests 8 (AVX2) or 16 (AVX-512) pairs
+*/
+class BoxNarrowphase {
+public:
+    void Clear();
+
+    // Pair of the first_index-th box of the first boxes and the second_index-th box of the second ones
+    void Add(const int first_index, const int second_index);
+
+    size_t GetSize() const { return pairs_count_; }
+
+    // overlaps[i] is set if the i-th added pair overlaps, touching boxes overlap
+    void TestOverlaps(const OrientedBoxes& first_boxes, const OrientedBoxes& second_boxes, std::vector<std::uint8_t>& overlaps) const;
+
+private:
+    size_t pairs_count_ = 0;
+
+    // WARNING: arrays are padded to the SIMD width by the pairs of the 0-th boxes, only first GetSize() values are meaningful
+    std::vector<std::int32_t> first_indices_;
+    std::vector<std::int32_t> second_indices_;
+};
+
+} // namespace App
\ No newline at end of file
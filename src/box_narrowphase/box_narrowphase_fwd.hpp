@@ -0,0 +1,10 @@
+#pragma once
+
+namespace App {
+
+struct OrientedBox;
+struct OrientedBoxes;
+
+class BoxNarrowphase;
+
+} // namespace App
\ No newline at end of file
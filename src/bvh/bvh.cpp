@@ -0,0 +1,529 @@
+#include "bvh.hpp"
+
+// LibSmartCar
+#include <simd/simd.hpp>
+
+namespace App {
+
+// Extern variables
+extern const int APP_BVH_MAX_LEAF_SIZE;
+extern const int APP_BVH_MAX_SAH_DEPTH;
+
+struct BvhStackEntry {
+    int node_index;
+    float t_near; // the node is skipped if all the rays already have a closer hit
+};
+
+struct BvhBin {
+    float min_point[3];
+    float max_point[3];
+    int count;
+};
+
+// Keeps 1 / direction finite, so the slab test never computes 0 * inf
+static float SafeInverse(const float value) {
+    constexpr float min_abs_value = 1e-20f;
+    if (std::fabs(value) < min_abs_value) {
+        return (value < 0.0f) ? (-1.0f / min_abs_value) : (1.0f / min_abs_value);
+    }
+    return 1.0f / value;
+}
+
+static float HalfArea(const float* min_point, const float* max_point) {
+    float dx = max_point[0] - min_point[0];
+    float dy = max_point[1] - min_point[1];
+    float dz = max_point[2] - min_point[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+static void GrowBounds(float* min_point, float* max_point, const ObstacleBounds& bounds, const int index) {
+    min_point[0] = (std::min)(min_point[0], bounds.min_x[index]);
+    min_point[1] = (std::min)(min_point[1], bounds.min_y[index]);
+    min_point[2] = (std::min)(min_point[2], bounds.min_z[index]);
+    max_point[0] = (std::max)(max_point[0], bounds.max_x[index]);
+    max_point[1] = (std::max)(max_point[1], bounds.max_y[index]);
+    max_point[2] = (std::max)(max_point[2], bounds.max_z[index]);
+}
+
+// Same as the compute shader: a box is hit if t_near <= t_far and t_near > 0
+static void SlabTest(const float* min_point, const float* max_point, const GL::Vec3& origin, const GL::Vec3& inverse_direction,
+    float& t_near, float& t_far) {
+    float t_min_x = (min_point[0] - origin.X) * inverse_direction.X;
+    float t_max_x = (max_point[0] - origin.X) * inverse_direction.X;
+    float t_min_y = (min_point[1] - origin.Y) * inverse_direction.Y;
+    float t_max_y = (max_point[1] - origin.Y) * inverse_direction.Y;
+    float t_min_z = (min_point[2] - origin.Z) * inverse_direction.Z;
+    float t_max_z = (max_point[2] - origin.Z) * inverse_direction.Z;
+
+    t_near = (std::max)({(std::min)(t_min_x, t_max_x), (std::min)(t_min_y, t_max_y), (std::min)(t_min_z, t_max_z)});
+    t_far = (std::min)({(std::max)(t_min_x, t_max_x), (std::max)(t_min_y, t_max_y), (std::max)(t_min_z, t_max_z)});
+}
+
+static void SlabTest(const float min_x, const float min_y, const float min_z, const float max_x, const float max_y, const float max_z,
+    const GL::Vec3& origin, const Simd::Float inverse_x, const Simd::Float inverse_y, const Simd::Float inverse_z,
+    Simd::Float& t_near, Simd::Float& t_far) {
+    using namespace Simd;
+
+    Float t_min_x = Broadcast(min_x - origin.X) * inverse_x;
+    Float t_max_x = Broadcast(max_x - origin.X) * inverse_x;
+    Float t_min_y = Broadcast(min_y - origin.Y) * inverse_y;
+    Float t_max_y = Broadcast(max_y - origin.Y) * inverse_y;
+    Float t_min_z = Broadcast(min_z - origin.Z) * inverse_z;
+    Float t_max_z = Broadcast(max_z - origin.Z) * inverse_z;
+
+    t_near = Max(Max(Min(t_min_x, t_max_x), Min(t_min_y, t_max_y)), Min(t_min_z, t_max_z));
+    t_far = Min(Min(Max(t_min_x, t_max_x), Max(t_min_y, t_max_y)), Max(t_min_z, t_max_z));
+}
+
+static float ReduceMin(const Simd::Float value) {
+    float lanes[Simd::APP_SIMD_WIDTH];
+    Simd::Store(lanes, value);
+    return *std::min_element(lanes, lanes + Simd::APP_SIMD_WIDTH);
+}
+
+static float ReduceMax(const Simd::Float value) {
+    float lanes[Simd::APP_SIMD_WIDTH];
+    Simd::Store(lanes, value);
+    return *std::max_element(lanes, lanes + Simd::APP_SIMD_WIDTH);
+}
+
+void ObstacleBounds::Clear() {
+    min_x.clear();
+    min_y.clear();
+    min_z.clear();
+    max_x.clear();
+    max_y.clear();
+    max_z.clear();
+}
+
+void ObstacleBounds::Add(const GL::Vec3& min_point, const GL::Vec3& max_point) {
+    min_x.push_back(min_point.X);
+    min_y.push_back(min_point.Y);
+    min_z.push_back(min_point.Z);
+    max_x.push_back(max_point.X);
+    max_y.push_back(max_point.Y);
+    max_z.push_back(max_point.Z);
+}
+
+void ObstacleBounds::Set(const size_t index, const GL::Vec3& min_point, const GL::Vec3& max_point) {
+    min_x[index] = min_point.X;
+    min_y[index] = min_point.Y;
+    min_z[index] = min_point.Z;
+    max_x[index] = max_point.X;
+    max_y[index] = max_point.Y;
+    max_z[index] = max_point.Z;
+}
+
+void ObstacleBounds::Erase(const size_t first_index, const size_t count) {
+    for (auto* component : {&min_x, &min_y, &min_z, &max_x, &max_y, &max_z}) {
+        component->erase(component->begin() + first_index, component->begin() + first_index + count);
+    }
+}
+
+void Bvh::Clear() {
+    nodes_.clear();
+    indices_.clear();
+    bounds_.Clear();
+}
+
+void Bvh::Build(const ObstacleBounds& bounds) {
+    Clear();
+
+    const int count = static_cast<int>(bounds.GetSize());
+    if (count == 0) {
+        return;
+    }
+
+    std::vector<float> centroids(3 * count);
+    indices_.resize(count);
+    for (int index = 0; index < count; ++index) {
+        indices_[index] = index;
+        centroids[3 * index + 0] = 0.5f * (bounds.min_x[index] + bounds.max_x[index]);
+        centroids[3 * index + 1] = 0.5f * (bounds.min_y[index] + bounds.max_y[index]);
+        centroids[3 * index + 2] = 0.5f * (bounds.min_z[index] + bounds.max_z[index]);
+    }
+
+    // Binary tree with N leaves at most has 2N - 1 nodes
+    nodes_.reserve(2 * count - 1);
+    nodes_.emplace_back();
+    BuildNode(0, 0, count, 0, bounds, centroids);
+
+    // Leaves reference contiguous ranges of the reordered bounds
+    for (int index : indices_) {
+        bounds_.Add(
+            GL::Vec3{bounds.min_x[index], bounds.min_y[index], bounds.min_z[index]},
+            GL::Vec3{bounds.max_x[index], bounds.max_y[index], bounds.max_z[index]}
+        );
+    }
+}
+
+void Bvh::BuildNode(const int node_index, const int first_index, const int count, const int depth,
+    const ObstacleBounds& bounds, const std::vector<float>& centroids) {
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+
+    BvhNode node{{infinity, infinity, infinity}, first_index, {-infinity, -infinity, -infinity}, count};
+    float centroid_min[3] = {infinity, infinity, infinity};
+    float centroid_max[3] = {-infinity, -infinity, -infinity};
+
+    for (int position = first_index; position < first_index + count; ++position) {
+        int index = indices_[position];
+        GrowBounds(node.min_point, node.max_point, bounds, index);
+        for (int axis = 0; axis < 3; ++axis) {
+            centroid_min[axis] = (std::min)(centroid_min[axis], centroids[3 * index + axis]);
+            centroid_max[axis] = (std::max)(centroid_max[axis], centroids[3 * index + axis]);
+        }
+    }
+    nodes_[node_index] = node;
+
+    if (count == 1) {
+        return;
+    }
+
+    // Binned SAH: cost of the split is left_count * left_area + right_count * right_area
+    float best_cost = infinity;
+    int best_axis = -1;
+    int best_bin = 0;
+
+    for (int axis = 0; (axis < 3) && (depth < APP_BVH_MAX_SAH_DEPTH); ++axis) {
+        float extent = centroid_max[axis] - centroid_min[axis];
+        if (extent <= 0.0f) {
+            continue;
+        }
+
+        BvhBin bins[APP_BVH_BINS_COUNT];
+        for (auto& bin : bins) {
+            bin = BvhBin{{infinity, infinity, infinity}, {-infinity, -infinity, -infinity}, 0};
+        }
+
+        float scale = APP_BVH_BINS_COUNT / extent;
+        for (int position = first_index; position < first_index + count; ++position) {
+            int index = indices_[position];
+            int bin_index = (std::min)(APP_BVH_BINS_COUNT - 1, static_cast<int>((centroids[3 * index + axis] - centroid_min[axis]) * scale));
+            GrowBounds(bins[bin_index].min_point, bins[bin_index].max_point, bounds, index);
+            ++bins[bin_index].count;
+        }
+
+        // Sweep from the left to get areas of the left parts, then from the right to evaluate the splits
+        float left_area[APP_BVH_BINS_COUNT - 1];
+        int left_count[APP_BVH_BINS_COUNT - 1];
+        BvhBin left_bin{{infinity, infinity, infinity}, {-infinity, -infinity, -infinity}, 0};
+        for (int bin_index = 0; bin_index < APP_BVH_BINS_COUNT - 1; ++bin_index) {
+            for (int component = 0; component < 3; ++component) {
+                left_bin.min_point[component] = (std::min)(left_bin.min_point[component], bins[bin_index].min_point[component]);
+                left_bin.max_point[component] = (std::max)(left_bin.max_point[component], bins[bin_index].max_point[component]);
+            }
+            left_bin.count += bins[bin_index].count;
+            left_area[bin_index] = HalfArea(left_bin.min_point, left_bin.max_point);
+            left_count[bin_index] = left_bin.count;
+        }
+
+        BvhBin right_bin{{infinity, infinity, infinity}, {-infinity, -infinity, -infinity}, 0};
+        for (int bin_index = APP_BVH_BINS_COUNT - 1; bin_index > 0; --bin_index) {
+            for (int component = 0; component < 3; ++component) {
+                right_bin.min_point[component] = (std::min)(right_bin.min_point[component], bins[bin_index].min_point[component]);
+                right_bin.max_point[component] = (std::max)(right_bin.max_point[component], bins[bin_index].max_point[component]);
+            }
+            right_bin.count += bins[bin_index].count;
+
+            // Split between bin_index - 1 and bin_index
+            if ((left_count[bin_index - 1] == 0) || (right_bin.count == 0)) {
+                continue;
+            }
+            float cost = left_count[bin_index - 1] * left_area[bin_index - 1] + right_bin.count * HalfArea(right_bin.min_point, right_bin.max_point);
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = bin_index;
+            }
+        }
+    }
+
+    float leaf_cost = count * HalfArea(node.min_point, node.max_point);
+    int* first = indices_.data() + first_index;
+    int* last = first + count;
+    int* middle = nullptr;
+
+    if ((best_axis >= 0) && ((best_cost < leaf_cost) || (count > APP_BVH_MAX_LEAF_SIZE))) {
+        float scale = APP_BVH_BINS_COUNT / (centroid_max[best_axis] - centroid_min[best_axis]);
+        middle = std::partition(first, last, [&](const int index) {
+            int bin_index = (std::min)(APP_BVH_BINS_COUNT - 1, static_cast<int>((centroids[3 * index + best_axis] - centroid_min[best_axis]) * scale));
+            return bin_index < best_bin;
+        });
+    } else if (count > APP_BVH_MAX_LEAF_SIZE) {
+        // No SAH split (too deep or equal centroids): median split keeps the depth logarithmic
+        int axis = 0;
+        for (int component = 1; component < 3; ++component) {
+            if (centroid_max[component] - centroid_min[component] > centroid_max[axis] - centroid_min[axis]) {
+                axis = component;
+            }
+        }
+        middle = first + count / 2;
+        std::nth_element(first, middle, last, [&](const int lhs, const int rhs) {
+            return centroids[3 * lhs + axis] < centroids[3 * rhs + axis];
+        });
+    } else {
+        return;
+    }
+
+    const int left_child_index = static_cast<int>(nodes_.size());
+    nodes_.emplace_back();
+    nodes_.emplace_back();
+    nodes_[node_index].first_index = left_child_index;
+    nodes_[node_index].count = 0;
+
+    const int left_count = static_cast<int>(middle - first);
+    BuildNode(left_child_index, first_index, left_count, depth + 1, bounds, centroids);
+    BuildNode(left_child_index + 1, first_index + left_count, count - left_count, depth + 1, bounds, centroids);
+}
+
+float Bvh::IntersectRay(const GL::Vec3& origin, const GL::Vec3& direction, int* hit_index) const {
+    float nearest = std::numeric_limits<float>::infinity();
+    int nearest_index = -1;
+
+    if (!IsEmpty()) {
+        GL::Vec3 inverse_direction{SafeInverse(direction.X), SafeInverse(direction.Y), SafeInverse(direction.Z)};
+
+        BvhStackEntry stack[APP_BVH_TRAVERSAL_STACK_SIZE];
+        int stack_size = 0;
+
+        float t_near = 0.0f;
+        float t_far = 0.0f;
+        SlabTest(nodes_[0].min_point, nodes_[0].max_point, origin, inverse_direction, t_near, t_far);
+        if ((t_near <= t_far) && (t_far > 0.0f)) {
+            stack[stack_size++] = BvhStackEntry{0, t_near};
+        }
+
+        while (stack_size > 0) {
+            const BvhStackEntry entry = stack[--stack_size];
+            if (entry.t_near >= nearest) {
+                continue;
+            }
+
+            const BvhNode& node = nodes_[entry.node_index];
+            if (node.count > 0) {
+                for (int position = node.first_index; position < node.first_index + node.count; ++position) {
+                    float box_min[3] = {bounds_.min_x[position], bounds_.min_y[position], bounds_.min_z[position]};
+                    float box_max[3] = {bounds_.max_x[position], bounds_.max_y[position], bounds_.max_z[position]};
+                    SlabTest(box_min, box_max, origin, inverse_direction, t_near, t_far);
+                    if ((t_near <= t_far) && (t_near > 0.0f) && (t_near < nearest)) {
+                        nearest = t_near;
+                        nearest_index = indices_[position];
+                    }
+                }
+                continue;
+            }
+
+            // Children are tested here, so the closer one is pushed last and visited first
+            BvhStackEntry children[2];
+            int children_count = 0;
+            for (int child_index = node.first_index; child_index < node.first_index + 2; ++child_index) {
+                SlabTest(nodes_[child_index].min_point, nodes_[child_index].max_point, origin, inverse_direction, t_near, t_far);
+                if ((t_near <= t_far) && (t_far > 0.0f) && (t_near < nearest)) {
+                    children[children_count++] = BvhStackEntry{child_index, t_near};
+                }
+            }
+            if ((children_count == 2) && (children[0].t_near < children[1].t_near)) {
+                std::swap(children[0], children[1]);
+            }
+            for (int child = 0; child < children_count; ++child) {
+                stack[stack_size++] = children[child];
+            }
+        }
+    }
+
+    if (hit_index) {
+        *hit_index = nearest_index;
+    }
+    return nearest;
+}
+
+float Bvh::IntersectRay(const GL::Vec3& origin, const GL::Vec3& direction, const BvhNarrowphase& narrowphase, const float max_distance) const {
+    if (IsEmpty()) {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    float nearest = max_distance;
+    GL::Vec3 inverse_direction{SafeInverse(direction.X), SafeInverse(direction.Y), SafeInverse(direction.Z)};
+
+    BvhStackEntry stack[APP_BVH_TRAVERSAL_STACK_SIZE];
+    int stack_size = 0;
+
+    // Boxes are only bounds here, so the ones around the origin are visited too
+    auto test_box = [&](const float* box_min, const float* box_max, float& t_near) {
+        float t_far = 0.0f;
+        SlabTest(box_min, box_max, origin, inverse_direction, t_near, t_far);
+        return (t_near <= t_far) && (t_far > 0.0f) && (t_near < nearest);
+    };
+
+    float t_near = 0.0f;
+    if (test_box(nodes_[0].min_point, nodes_[0].max_point, t_near)) {
+        stack[stack_size++] = BvhStackEntry{0, t_near};
+    }
+
+    while (stack_size > 0) {
+        const BvhStackEntry entry = stack[--stack_size];
+        if (entry.t_near >= nearest) {
+            continue;
+        }
+
+        const BvhNode& node = nodes_[entry.node_index];
+        if (node.count > 0) {
+            for (int position = node.first_index; position < node.first_index + node.count; ++position) {
+                float box_min[3] = {bounds_.min_x[position], bounds_.min_y[position], bounds_.min_z[position]};
+                float box_max[3] = {bounds_.max_x[position], bounds_.max_y[position], bounds_.max_z[position]};
+                if (!test_box(box_min, box_max, t_near)) {
+                    continue;
+                }
+
+                float distance = narrowphase(indices_[position], t_near, nearest);
+                if ((distance > 0.0f) && (distance < nearest)) {
+                    nearest = distance;
+                }
+            }
+            continue;
+        }
+
+        BvhStackEntry children[2];
+        int children_count = 0;
+        for (int child_index = node.first_index; child_index < node.first_index + 2; ++child_index) {
+            if (test_box(nodes_[child_index].min_point, nodes_[child_index].max_point, t_near)) {
+                children[children_count++] = BvhStackEntry{child_index, t_near};
+            }
+        }
+        if ((children_count == 2) && (children[0].t_near < children[1].t_near)) {
+            std::swap(children[0], children[1]);
+        }
+        for (int child = 0; child < children_count; ++child) {
+            stack[stack_size++] = children[child];
+        }
+    }
+    return (nearest < max_distance) ? nearest : std::numeric_limits<float>::infinity();
+}
+
+void Bvh::IntersectRays(const GL::Vec3& origin, const float* direction_x, const float* direction_y, const float* direction_z,
+    float* distances, const int rays_count, const float max_distance) const {
+    using namespace Simd;
+
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    const Float zero = Broadcast(0.0f);
+    const Float packet_max_distance = Broadcast(max_distance);
+
+    for (int packet_start = 0; packet_start < rays_count; packet_start += APP_SIMD_WIDTH) {
+        // Running minimum starting from the max distance, so no obstacles x rays matrix is needed
+        Float nearest = packet_max_distance;
+        if (IsEmpty()) {
+            Store(distances + packet_start, Broadcast(infinity));
+            continue;
+        }
+
+        float inverse_x[APP_SIMD_WIDTH];
+        float inverse_y[APP_SIMD_WIDTH];
+        float inverse_z[APP_SIMD_WIDTH];
+        for (int lane = 0; lane < APP_SIMD_WIDTH; ++lane) {
+            inverse_x[lane] = SafeInverse(direction_x[packet_start + lane]);
+            inverse_y[lane] = SafeInverse(direction_y[packet_start + lane]);
+            inverse_z[lane] = SafeInverse(direction_z[packet_start + lane]);
+        }
+        const Float packet_inverse_x = Load(inverse_x);
+        const Float packet_inverse_y = Load(inverse_y);
+        const Float packet_inverse_z = Load(inverse_z);
+
+        // The whole packet descends into a node if any of its rays hits the node
+        auto test_node = [&](const BvhNode& node, float& packet_t_near) {
+            Float t_near{};
+            Float t_far{};
+            SlabTest(node.min_point[0], node.min_point[1], node.min_point[2], node.max_point[0], node.max_point[1], node.max_point[2],
+                origin, packet_inverse_x, packet_inverse_y, packet_inverse_z, t_near, t_far);
+
+            Mask visit = (t_near <= t_far) & (t_far > zero) & (t_near < nearest);
+            packet_t_near = ReduceMin(Select(visit, Broadcast(infinity), t_near));
+            return Any(visit);
+        };
+
+        BvhStackEntry stack[APP_BVH_TRAVERSAL_STACK_SIZE];
+        int stack_size = 0;
+
+        float packet_t_near = 0.0f;
+        if (test_node(nodes_[0], packet_t_near)) {
+            stack[stack_size++] = BvhStackEntry{0, packet_t_near};
+        }
+
+        while (stack_size > 0) {
+            const BvhStackEntry entry = stack[--stack_size];
+            if (entry.t_near >= ReduceMax(nearest)) {
+                continue;
+            }
+
+            const BvhNode& node = nodes_[entry.node_index];
+            if (node.count > 0) {
+                for (int position = node.first_index; position < node.first_index + node.count; ++position) {
+                    Float t_near{};
+                    Float t_far{};
+                    SlabTest(bounds_.min_x[position], bounds_.min_y[position], bounds_.min_z[position],
+                        bounds_.max_x[position], bounds_.max_y[position], bounds_.max_z[position],
+                        origin, packet_inverse_x, packet_inverse_y, packet_inverse_z, t_near, t_far);
+
+                    // Rays starting inside the box don't hit it
+                    Mask hit = (t_near <= t_far) & (t_near > zero);
+                    nearest = Select(hit, nearest, Min(nearest, t_near));
+                }
+                continue;
+            }
+
+            BvhStackEntry children[2];
+            int children_count = 0;
+            for (int child_index = node.first_index; child_index < node.first_index + 2; ++child_index) {
+                if (test_node(nodes_[child_index], packet_t_near)) {
+                    children[children_count++] = BvhStackEntry{child_index, packet_t_near};
+                }
+            }
+            if ((children_count == 2) && (children[0].t_near < children[1].t_near)) {
+                std::swap(children[0], children[1]);
+            }
+            for (int child = 0; child < children_count; ++child) {
+                stack[stack_size++] = children[child];
+            }
+        }
+        // Rays which found nothing closer than the max distance didn't hit anything
+        Store(distances + packet_start, Select(nearest >= packet_max_distance, nearest, Broadcast(infinity)));
+    }
+}
+
+void Bvh::QueryOverlaps(const GL::Vec3& min_point, const GL::Vec3& max_point, std::vector<int>& result) const {
+    if (IsEmpty()) {
+        return;
+    }
+
+    auto overlaps = [&](const float* box_min, const float* box_max) {
+        return (box_min[0] <= max_point.X) && (min_point.X <= box_max[0])
+            && (box_min[1] <= max_point.Y) && (min_point.Y <= box_max[1])
+            && (box_min[2] <= max_point.Z) && (min_point.Z <= box_max[2]);
+    };
+
+    int stack[APP_BVH_TRAVERSAL_STACK_SIZE];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const BvhNode& node = nodes_[stack[--stack_size]];
+        if (!overlaps(node.min_point, node.max_point)) {
+            continue;
+        }
+
+        if (node.count > 0) {
+            for (int position = node.first_index; position < node.first_index + node.count; ++position) {
+                float box_min[3] = {bounds_.min_x[position], bounds_.min_y[position], bounds_.min_z[position]};
+                float box_max[3] = {bounds_.max_x[position], bounds_.max_y[position], bounds_.max_z[position]};
+                if (overlaps(box_min, box_max)) {
+                    result.push_back(indices_[position]);
+                }
+            }
+            continue;
+        }
+
+        stack[stack_size++] = node.first_index + 1;
+        stack[stack_size++] = node.first_index;
+    }
+}
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+// STL
+#define NOMINMAX
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// OpenGL Wrapper
+#include <GL/OOGL.hpp>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <bvh/bvh_fwd.hpp>
+
+namespace App {
+
+// World space obstacle bounds stored as structure of arrays for the CPU backends
+struct ObstacleBounds {
+    void Clear();
+    void Add(const GL::Vec3& min_point, const GL::Vec3& max_point);
+    void Set(const size_t index, const GL::Vec3& min_point, const GL::Vec3& max_point);
+    void Erase(const size_t first_index, const size_t count);
+    size_t GetSize() const { return min_x.size(); }
+
+    std::vector<float> min_x;
+    std::vector<float> min_y;
+    std::vector<float> min_z;
+    std::vector<float> max_x;
+    std::vector<float> max_y;
+    std::vector<float> max_z;
+};
+
+/*
+    Inner node: count == 0, children are stored at first_index and first_index + 1
+    Leaf: boxes [first_index, first_index + count) in the BVH order
+*/
+struct BvhNode {
+    float min_point[3];
+    int first_index;
+    float max_point[3];
+    int count;
+};
+static_assert(sizeof(BvhNode) == 32);
+
+/*
+    Exact hit distance of the ray with the object inside the box (infinity if missed).
+    Gets the box distance (may be negative if the ray starts inside the box) and the closest hit found so far,
+    hits farther than it may be skipped.
+    WARNING: only refers to the callable (no copy, no allocation), so it must outlive the query, a lambda passed in place does
+*/
+class BvhNarrowphase {
+public:
+    template <typename Function>
+    BvhNarrowphase(const Function& function) : function_(&function), call_(&Call<Function>) {}
+
+    float operator()(const int box_index, const float box_distance, const float nearest) const {
+        return call_(function_, box_index, box_distance, nearest);
+    }
+
+private:
+    template <typename Function>
+    static float Call(const void* function, const int box_index, const float box_distance, const float nearest) {
+        return (*static_cast<const Function*>(function))(box_index, box_distance, nearest);
+    }
+
+    const void* function_;
+    float (*call_)(const void* function, const int box_index, const float box_distance, const float nearest);
+};
+
+/*
+    Bounding volume hierarchy over the obstacle boxes, built with binned SAH.
+    Queries use an explicit stack, so their cost grows logarithmically with the number of boxes
+*/
+class Bvh {
+public:
+    void Build(const ObstacleBounds& bounds);
+    void Clear();
+
+    bool IsEmpty() const { return nodes_.empty(); }
+    size_t GetNodesCount() const { return nodes_.size(); }
+
+    // Nearest hit with t > 0 (infinity if nothing is hit), hit_index gets the box index passed to Build
+    float IntersectRay(const GL::Vec3& origin, const GL::Vec3& direction, int* hit_index = nullptr) const;
+
+    /*
+        Two-level query: every box the ray passes through (including the boxes around the origin)
+        is refined by the narrowphase, hits not closer than max_distance are reported as infinity
+    */
+    float IntersectRay(const GL::Vec3& origin, const GL::Vec3& direction, const BvhNarrowphase& narrowphase,
+        const float max_distance = std::numeric_limits<float>::infinity()) const;
+
+    /*
+        Same for a fan of rays sharing the origin, traversed in packets of APP_SIMD_WIDTH rays.
+        Only hits closer than max_distance are reported, farther nodes are not visited at all
+        WARNING: rays_count has to be a multiple of the widest SIMD width (16)
+    */
+    void IntersectRays(const GL::Vec3& origin, const float* direction_x, const float* direction_y, const float* direction_z,
+        float* distances, const int rays_count, const float max_distance = std::numeric_limits<float>::infinity()) const;
+
+    // Appends indices of all the boxes overlapping [min_point, max_point]
+    void QueryOverlaps(const GL::Vec3& min_point, const GL::Vec3& max_point, std::vector<int>& result) const;
+
+private:
+    void BuildNode(const int node_index, const int first_index, const int count, const int depth,
+        const ObstacleBounds& bounds, const std::vector<float>& centroids);
+
+    std::vector<BvhNode> nodes_;
+
+    // Box indices passed to Build and their bounds, both in the leaves order
+    std::vector<int> indices_;
+    ObstacleBounds bounds_;
+};
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace App {
+
+struct ObstacleBounds;
+struct BvhNode;
+
+class Bvh;
+
+} // namespace App
\ No newline at end of file
@@ -4,6 +4,8 @@ namespace App {
 
 // Extern variables
 extern const GL::Vec3 APP_CAR_WHEELS_ROTATION_AXIS;
+extern const int APP_CAR_HULL_CONTACT_MAX_ITERATIONS;
+extern const float APP_INTERSECTOR_CONTACT_SKIN;
 
 CarModel::CarModel(const std::string& name, const std::string& default_shader_name,
     const std::string& bbox_shader_name, const std::string& gltf,
@@ -11,18 +13,22 @@ CarModel::CarModel(const std::string& name, const std::string& default_shader_na
     const float acceleration, const float rotate_max_speed, const float wheels_rotate_speed,
     const GL::Vec3& center_translation, const Transform& transform)
     : Model(name, default_shader_name, bbox_shader_name, gltf, transform),
-    move_max_speed_(move_max_speed),
-    rotate_max_speed_(rotate_max_speed),
-    wheels_rotate_speed_(wheels_rotate_speed),
+    state_(CarState{}),
+    params_(CarParams{Accelerator{move_max_speed, acceleration}, rotate_max_speed, wheels_rotate_speed}),
+    precomputed_state_(state_),
+    wheels_angle_(0.0f),
     center_translation_(GL::Mat4{}.Translate(center_translation)),
-    accelerator_(Accelerator{move_max_speed, acceleration}) {
+    movement_transform_(GL::Mat4{}),
+    movement_transform_outdated_(true) {
     wheel_meshes_indicies_.reserve(wheel_meshes_names.size());
+    mesh_collision_groups_.assign(meshes_.size(), static_cast<int>(CarCollisionGroup::BODY));
     for (auto&& wheel_mesh_name : wheel_meshes_names) {
         auto found = std::find_if(meshes_.begin(), meshes_.end(), [wheel_mesh_name](const App::Mesh& mesh) {
             return mesh.name_ == wheel_mesh_name;
         });
         if (found != meshes_.end()) {
             wheel_meshes_indicies_.push_back(found - meshes_.begin());
+            mesh_collision_groups_[found - meshes_.begin()] = static_cast<int>(CarCollisionGroup::WHEELS);
         }
     }
 }
@@ -33,128 +39,168 @@ CarModel::CarModel(const Config::CarModelConfig& config)
         config.wheels.speed.rotate, config.rotation_center, config.transform) {}
 
 const GL::Mat4 CarModel::GetModelMatrix() const {
-    return static_cast<GL::Mat4>(transform_) * movement_transform_ * center_translation_;
+    return static_cast<GL::Mat4>(transform_) * GetMovementTransform() * center_translation_;
 }
 
 const float CarModel::GetSpeed() const {
-    return accelerator_.GetSpeed();
+    return state_.speed;
+}
+
+const bool CarModel::WasStopped() const {
+    return state_.was_stopped;
 }
 
 const GL::Vec3 CarModel::GetPosition() const {
-    return GetTranslation(movement_transform_);
+    return GL::Vec3{state_.x, 0.0f, state_.z};
 }
 
-void CarModel::Move(float delta_time) {
-    auto& context = App::Context::Get();
-    if (context.keyboard_mode.value() == App::KeyboardMode::CAR_MOVEMENT) {
-        if (context.keyboard_status.value()[GL::Key::W]) {
-            accelerator_.IncreaseSpeed(delta_time, true);
-        }
-        if (context.keyboard_status.value()[GL::Key::S]) {
-            accelerator_.IncreaseSpeed(delta_time, false);
-        }
-        if (context.keyboard_status.value()[GL::Key::A]) {
-            RotateLeft(delta_time, accelerator_.GetSpeed() > 0.0);
-        }
-        if (context.keyboard_status.value()[GL::Key::D]) {
-            RotateRight(delta_time, accelerator_.GetSpeed() > 0.0);
-        }
-    } else if (context.keyboard_mode.value() == App::KeyboardMode::NN_LEARNING) {
-        context.user_selected_actions.fill(false);
-        if (context.keyboard_status.value()[GL::Key::W]) {
-            accelerator_.IncreaseSpeed(delta_time, true);
-            context.user_selected_actions[0] = true;
-        }
-        if (context.keyboard_status.value()[GL::Key::S]) {
-            accelerator_.IncreaseSpeed(delta_time, false);
-            context.user_selected_actions[1] = true;
-        }
-        if (context.keyboard_status.value()[GL::Key::A]) {
-            RotateLeft(delta_time, accelerator_.GetSpeed() > 0.0);
-            context.user_selected_actions[2] = true;
-        }
-        if (context.keyboard_status.value()[GL::Key::D]) {
-            RotateRight(delta_time, accelerator_.GetSpeed() > 0.0);
-            context.user_selected_actions[3] = true;
-        }
-    } else if (context.keyboard_mode.value() == App::KeyboardMode::NN_TEST) {
-        if (context.actions[0]) {
-            accelerator_.IncreaseSpeed(delta_time, true);
-        }
-        if (context.actions[1]) {
-            accelerator_.IncreaseSpeed(delta_time, false);
-        }
-        if (context.actions[2]) {
-            RotateLeft(delta_time, accelerator_.GetSpeed() > 0.0);
-        }
-        if (context.actions[3]) {
-            RotateRight(delta_time, accelerator_.GetSpeed() > 0.0);
-        }
-    }
-    // else if (context.keyboard_mode.value() == App::KeyboardMode::NN_LEARNING) {
-    //     if (context.actions[0]) {
-    //         accelerator_.IncreaseSpeed(delta_time, true);
-    //     }
-    //     if (context.actions[1]) {
-    //         accelerator_.IncreaseSpeed(delta_time, false);
-    //     }
-    //     if (context.actions[2]) {
-    //         RotateLeft(delta_time, accelerator_.GetSpeed() > 0.0);
-    //     }
-    //     if (context.actions[3]) {
-    //         RotateRight(delta_time, accelerator_.GetSpeed() > 0.0);
-    //     }
-    // }
-    MoveForward(delta_time);
+const float CarModel::GetYaw() const {
+    return state_.yaw;
+}
+
+void CarModel::SetState(const CarState& state) {
+    state_ = state;
+    movement_transform_outdated_ = true;
+    UpdateWheels();
+}
+
+void CarModel::Move(const CarActions& actions, float delta_time, const bool update_rays) {
+    precomputed_state_ = state_;
+    Step(precomputed_state_, actions, delta_time, params_);
 
     // Do intersection
-    std::vector<int> intersection_result{};
+    bool is_colliding = false;
+    contact_mesh_indices_.clear();
     if (collision_intersector_) {
         collision_intersector_->ClearCarParts();
         collision_intersector_->AddCarParts(this);
 
+        // Car is advanced to the first contact instead of dropping the whole step
+        if (collision_intersector_->IsContinuous()) {
+            const CarState end_state = precomputed_state_;
+            float contact_fraction = collision_intersector_->IntersectSwept(CollectMABB(state_));
+            if (contact_fraction < 1.0f) {
+                const std::vector<int>& contact_result = collision_intersector_->GetIntersectedCarPartMeshIndices(0);
+                contact_mesh_indices_.assign(contact_result.begin(), contact_result.end());
+                precomputed_state_ = Interpolate(state_, end_state, contact_fraction);
+                if (collision_intersector_->IsConvexHullNarrowphase()) {
+                    AdvanceToHullContact(end_state, contact_fraction);
+                }
+                collision_intersector_->SetCarModelMatrix(0, GetStateModelMatrix(precomputed_state_));
+            }
+        }
+
         collision_intersector_->Intersect();
-        intersection_result = collision_intersector_->GetIntersectedCarPartMeshIndices(0);
+        is_colliding = !collision_intersector_->GetCollisions().empty();
     }
     
     // No collisions found - car can be moved
-    if (intersection_result.empty()) { 
-        UpdateMovementTransform();
-        RotateWheels(accelerator_.GetSpeed() * delta_time);
+    if (!is_colliding) { 
+        state_ = precomputed_state_;
+        if (!contact_mesh_indices_.empty()) {
+            Stop(state_);
+            for (auto mesh_index : contact_mesh_indices_) {
+                DrawBBoxOnCollision(mesh_index);
+            }
+        }
     } else {
-        accelerator_.Stop();
-        for (auto mesh_index : intersection_result) {
+        Stop(state_);
+        for (auto mesh_index : collision_intersector_->GetIntersectedCarPartMeshIndices(0)) {
             DrawBBoxOnCollision(mesh_index);
         }
     }
-    ClearPrecomputedMovementTransform();
-
-    // If the car is moving - keep updating the camera
-    // If the car is still - update the camera only in case there was a collision
-    if ((accelerator_.GetSpeed() != 0.0f) || (accelerator_.WasStopped() && !context.camera->ReachedFinalPosition())) {
-        context.camera->UpdateWithModel(GetModelMatrix());
-    }
+    movement_transform_outdated_ = true;
+    UpdateWheels();
 
     // Update distances to obstacles
-    ray_intersector_->Intersect(GetModelMatrix());
-    context.distances_from_rays = ray_intersector_->GetResultDistances();
+    if (update_rays) {
+        ray_intersector_->Intersect(GetModelMatrix());
+    }
+    if (lidar_) {
+        lidar_->Update(GetModelMatrix(), delta_time);
+    }
+}
 
-    if (context.keyboard_mode.value() == App::KeyboardMode::CAR_MOVEMENT) {
-        if (context.keyboard_status.value()[GL::Key::W] || context.keyboard_status.value()[GL::Key::S]) {
+void CarModel::AdvanceToHullContact(const CarState& end_state, const float contact_fraction) {
+    /*
+        Boxes touch before the meshes do, the rest of the motion is made by conservative advancement:
+        no point of the car moves farther than the motion bound, so the car advanced by the distance between
+        the hulls over the bound can't reach any obstacle, thin ones included
+    */
+    const float motion_bound = GetMotionBound(state_, end_state);
+    const std::vector<MemoryAlignedBBox> end_car_parts_bboxes = CollectMABB(end_state);
+    float fraction = contact_fraction;
+    for (int iteration = 0; iteration < APP_CAR_HULL_CONTACT_MAX_ITERATIONS; ++iteration) {
+        precomputed_state_ = Interpolate(state_, end_state, fraction);
+        collision_intersector_->SetCarModelMatrix(0, GetStateModelMatrix(precomputed_state_));
+        float distance = collision_intersector_->GetConvexHullsDistance(end_car_parts_bboxes, APP_INTERSECTOR_CONTACT_SKIN);
+        if (distance <= APP_INTERSECTOR_CONTACT_SKIN) {
+            const std::vector<int>& contact_result = collision_intersector_->GetIntersectedCarPartMeshIndices(0);
+            contact_mesh_indices_.assign(contact_result.begin(), contact_result.end());
             return;
         }
-    }
-    if (context.keyboard_mode.value() == App::KeyboardMode::NN_LEARNING) {
-        if (context.keyboard_status.value()[GL::Key::W] || context.keyboard_status.value()[GL::Key::S]) {
+        if (motion_bound * (1.0f - fraction) <= distance - APP_INTERSECTOR_CONTACT_SKIN) {
+            // Rest of the step is free of contacts
+            precomputed_state_ = end_state;
+            contact_mesh_indices_.clear();
             return;
         }
+        fraction = (std::min)(fraction + (distance - 0.5f * APP_INTERSECTOR_CONTACT_SKIN) / motion_bound, 1.0f);
     }
-    if (context.keyboard_mode.value() == App::KeyboardMode::NN_TEST) {
-        if (context.actions[0] || context.actions[1]) {
-            return;
+    // Car stays at the last checked pose, the contacts of the boxes are kept
+}
+
+float CarModel::GetMotionBound(const CarState& state, const CarState& end_state) const {
+    // Norm of the model transform bounds its scaling, the movement is the ground plane translation and the rotation around Y axis
+    const GL::Mat4 transform = static_cast<GL::Mat4>(transform_);
+    float scale = 0.0f;
+    for (int column = 0; column < 3; ++column) {
+        for (int row = 0; row < 3; ++row) {
+            scale += transform.m[4 * column + row] * transform.m[4 * column + row];
         }
     }
-    accelerator_.DecreaseSpeed(delta_time);
+    scale = std::sqrt(scale);
+
+    // Box corners of the meshes are the farthest points from the rotation axis
+    float radius = 0.0f;
+    for (auto&& mesh : meshes_) {
+        auto mabb = mesh.GetMABB();
+        GL::Mat4 mesh_to_car = center_translation_ * mabb.mesh_to_model;
+        for (int corner = 0; corner < 8; ++corner) {
+            GL::Vec3 point{
+                (corner & 1) ? mabb.max_point.X : mabb.min_point.X,
+                (corner & 2) ? mabb.max_point.Y : mabb.min_point.Y,
+                (corner & 4) ? mabb.max_point.Z : mabb.min_point.Z
+            };
+            GL::Vec3 car_point = mesh_to_car * point;
+            radius = (std::max)(radius, std::sqrt(car_point.X * car_point.X + car_point.Z * car_point.Z));
+        }
+    }
+
+    float delta_x = end_state.x - state.x;
+    float delta_z = end_state.z - state.z;
+    float delta_yaw = std::remainder(end_state.yaw - state.yaw, static_cast<float>(2.0 * APP_MATH_PI));
+    return scale * (std::sqrt(delta_x * delta_x + delta_z * delta_z) + std::abs(delta_yaw) * radius);
+}
+
+void CarModel::SetObstacleRegistry(std::shared_ptr<ObstacleRegistry> obstacle_registry) {
+    obstacle_registry_ = std::move(obstacle_registry);
+    ShareObstacleRegistry();
+}
+
+void CarModel::ShareObstacleRegistry() {
+    if (!obstacle_registry_) {
+        return;
+    }
+    if (collision_intersector_) {
+        collision_intersector_->SetObstacleRegistry(obstacle_registry_);
+    }
+    if (ray_intersector_) {
+        ray_intersector_->SetObstacleRegistry(obstacle_registry_);
+    }
+    if (lidar_) {
+        lidar_->SetObstacleRegistry(obstacle_registry_);
+    }
 }
 
 void CarModel::SetDrawWheelsBBoxes(bool value) {
@@ -164,52 +210,76 @@ void CarModel::SetDrawWheelsBBoxes(bool value) {
 }
 
 std::vector<MemoryAlignedBBox> CarModel::CollectMABB() const {
-    std::vector<MemoryAlignedBBox> result;
+    return CollectMABB(precomputed_state_);
+}
+
+std::vector<ConvexHullInstance> CarModel::CollectConvexHulls() const {
+    std::vector<ConvexHullInstance> result;
     result.reserve(meshes_.size());
 
+    GL::Mat4 state_model_matrix = GetStateModelMatrix(precomputed_state_);
     for (auto&& mesh : meshes_) {
-        auto mabb = mesh.GetMABB();
-        mabb.model = GetPrecomputedModelMatrix();
-        result.push_back(mabb);
+        auto instance = mesh.GetConvexHullInstance();
+        instance.mesh_to_world = state_model_matrix * instance.mesh_to_world;
+        result.push_back(instance);
     }
     return result;
 }
 
-void CarModel::RotateWheels(float delta_time) {
-    for (auto index : wheel_meshes_indicies_) {
-        meshes_[index].self_transform_.UpdateRotation(wheels_rotate_speed_ * delta_time, APP_CAR_WHEELS_ROTATION_AXIS);
-        meshes_[index].bbox_.UpdateVertices(meshes_[index].self_transform_);
+std::vector<MemoryAlignedBBox> CarModel::CollectMABB(const CarState& state) const {
+    std::vector<MemoryAlignedBBox> result;
+    result.reserve(meshes_.size());
+
+    GL::Mat4 state_model_matrix = GetStateModelMatrix(state);
+    for (auto&& mesh : meshes_) {
+        auto mabb = mesh.GetMABB();
+        mabb.model = state_model_matrix;
+        result.push_back(mabb);
     }
+    return result;
 }
 
-void CarModel::MoveForward(float delta_time) {
-    precomputed_movement_transform_.Translate(GL::Vec3(0.0f, 0.0f, accelerator_.GetSpeed() * delta_time));
-}
+GL::Mat4 CarModel::ComputeMovementTransform(const CarState& state) {
+    // Rotation around Y axis by yaw followed by translation on the ground plane (column-major)
+    float sin_yaw = std::sin(state.yaw);
+    float cos_yaw = std::cos(state.yaw);
 
-void CarModel::RotateLeft(float delta_time, bool move_front) {
-    if (accelerator_.GetSpeed() != 0.0) {
-        float rotate_speed = rotate_max_speed_ * accelerator_.GetSpeed() / move_max_speed_;
-        precomputed_movement_transform_.Rotate(GL::Vec3(0.0f, 1.0f, 0.0f), rotate_speed * delta_time);
-    }
+    GL::Mat4 result{};
+    result.m[0] = cos_yaw;
+    result.m[2] = -sin_yaw;
+    result.m[8] = sin_yaw;
+    result.m[10] = cos_yaw;
+    result.m[12] = state.x;
+    result.m[14] = state.z;
+    return result;
 }
 
-void CarModel::RotateRight(float delta_time, bool move_front) {
-    if (accelerator_.GetSpeed() != 0.0) {
-        float rotate_speed = rotate_max_speed_ * accelerator_.GetSpeed() / move_max_speed_;
-        precomputed_movement_transform_.Rotate(GL::Vec3(0.0f, 1.0f, 0.0f), -1.0f * rotate_speed * delta_time);
+const GL::Mat4& CarModel::GetMovementTransform() const {
+    if (movement_transform_outdated_) {
+        movement_transform_ = ComputeMovementTransform(state_);
+        movement_transform_outdated_ = false;
     }
+    return movement_transform_;
 }
 
-void CarModel::ClearPrecomputedMovementTransform() {
-    precomputed_movement_transform_ = movement_transform_;
+void CarModel::UpdateWheels() {
+    // WARNING: wheels angle is wrapped by Step, so the difference is wrapped too
+    RotateWheels(std::remainder(state_.wheels_angle - wheels_angle_, 360.0f));
+    wheels_angle_ = state_.wheels_angle;
 }
 
-void CarModel::UpdateMovementTransform() {
-    movement_transform_ = precomputed_movement_transform_;
+void CarModel::RotateWheels(float rotate_degrees) {
+    if (rotate_degrees == 0.0f) {
+        return;
+    }
+    for (auto index : wheel_meshes_indicies_) {
+        meshes_[index].self_transform_.UpdateRotation(rotate_degrees, APP_CAR_WHEELS_ROTATION_AXIS);
+        meshes_[index].bbox_.UpdateVertices(meshes_[index].self_transform_);
+    }
 }
 
-const GL::Mat4 CarModel::GetPrecomputedModelMatrix() const {
-    return static_cast<GL::Mat4>(transform_) * precomputed_movement_transform_ * center_translation_;
+const GL::Mat4 CarModel::GetStateModelMatrix(const CarState& state) const {
+    return static_cast<GL::Mat4>(transform_) * ComputeMovementTransform(state) * center_translation_;
 }
 
 } // namespace App
\ No newline at end of file
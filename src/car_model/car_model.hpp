@@ -14,9 +14,10 @@
 #include <camera/camera.hpp>
 #include <model/model.hpp>
 #include <transform/transform.hpp>
-#include <accelerator/accelerator.hpp>
+#include <car_state/car_state.hpp>
 #include <intersector/intersector.hpp>
 #include <ray_intersector/ray_intersector.hpp>
+#include <lidar/lidar.hpp>
 
 namespace App {
 
@@ -32,48 +33,88 @@ public:
     virtual const GL::Mat4 GetModelMatrix() const override;
 
     // For collision check
-    void SetCollisionIntersector(Config::IntersectorConfig collision_intersector_config) { collision_intersector_ = std::make_shared<CollisionIntersector>(collision_intersector_config); }
+    void SetCollisionIntersector(Config::IntersectorConfig collision_intersector_config) { collision_intersector_ = std::make_shared<CollisionIntersector>(collision_intersector_config); ShareObstacleRegistry(); }
     std::shared_ptr<CollisionIntersector> GetCollisionIntersector() { return collision_intersector_; }
 
     // To compute distances to obstacles
-    void SetRayIntersector(Config::IntersectorConfig ray_intersector_config) { ray_intersector_ = std::make_shared<RayIntersector>(ray_intersector_config); }
+    void SetRayIntersector(Config::IntersectorConfig ray_intersector_config) { ray_intersector_ = std::make_shared<RayIntersector>(ray_intersector_config); ShareObstacleRegistry(); }
     std::shared_ptr<RayIntersector> GetRayIntersector() { return ray_intersector_; }
+
+    // Optional 3D scanning sensor, updated on every move
+    void SetLidar(Config::LidarConfig lidar_config) { lidar_ = std::make_shared<Lidar>(lidar_config); ShareObstacleRegistry(); }
+    std::shared_ptr<Lidar> GetLidar() { return lidar_; }
+
+    // Obstacles of the world, shared by all the sensors of the car (including the ones set later)
+    void SetObstacleRegistry(std::shared_ptr<ObstacleRegistry> obstacle_registry);
     
     const float GetSpeed() const;
+    const bool WasStopped() const;
     const GL::Vec3 GetPosition() const;
-    void Move(float delta_time);
+    const float GetYaw() const;
+
+    // Kinematic state may be saved and restored, meshes follow it
+    const CarState& GetState() const { return state_; }
+    void SetState(const CarState& state);
+
+    // Rays may be skipped when the caller senses many cars at once with RayIntersector::IntersectBatch
+    void Move(const CarActions& actions, float delta_time, const bool update_rays = true);
     void SetDrawWheelsBBoxes(bool value);
     virtual std::vector<MemoryAlignedBBox> CollectMABB() const override;
+    virtual std::vector<ConvexHullInstance> CollectConvexHulls() const override;
+
+    // CarCollisionGroup of every mesh, in the CollectMABB order
+    const std::vector<int>& GetMeshCollisionGroups() const { return mesh_collision_groups_; }
 
 private:
-    void RotateWheels(float delta_time);
-    void MoveForward(float delta_time);
-    void RotateLeft(float delta_time, bool move_front);
-    void RotateRight(float delta_time, bool move_front);
+    static GL::Mat4 ComputeMovementTransform(const CarState& state);
+
+    // Boxes of the meshes with the car moved to the state
+    std::vector<MemoryAlignedBBox> CollectMABB(const CarState& state) const;
+
+    // Car stopped by the swept boxes is moved further towards the end state while its hulls don't collide
+    void AdvanceToHullContact(const CarState& end_state, const float contact_fraction);
+
+    // Largest distance a point of the car moves over the whole motion between the states
+    float GetMotionBound(const CarState& state, const CarState& end_state) const;
 
-    void ClearPrecomputedMovementTransform();
-    void UpdateMovementTransform();
+    // Movement transform is built from the state only when it is needed
+    const GL::Mat4& GetMovementTransform() const;
+
+    // Sensors without the shared registry keep their own obstacles
+    void ShareObstacleRegistry();
+
+    // Rotates wheel meshes to the state wheels angle
+    void UpdateWheels();
+    void RotateWheels(float rotate_degrees);
 
     // For collision check
-    const GL::Mat4 GetPrecomputedModelMatrix() const;
+    const GL::Mat4 GetStateModelMatrix(const CarState& state) const;
     std::shared_ptr<CollisionIntersector> collision_intersector_;
     std::shared_ptr<RayIntersector> ray_intersector_;
+    std::shared_ptr<Lidar> lidar_;
+    std::shared_ptr<ObstacleRegistry> obstacle_registry_;
 
-    // Should be also kept there to compute rotation speed
-    float move_max_speed_;
-    float rotate_max_speed_;
-    float wheels_rotate_speed_;
     std::vector<size_t> wheel_meshes_indicies_;
+    std::vector<int> mesh_collision_groups_;
 
-    const GL::Mat4 center_translation_;
-    GL::Mat4 movement_transform_;
+    CarState state_;
+    const CarParams params_;
+
+    // If there won't be any collisions after check, set it as the resulting state
+    CarState precomputed_state_;
 
-    // If there won't be any collisions after check, set it as the resulting movement
-    GL::Mat4 precomputed_movement_transform_;
+    // Meshes touching obstacles after the swept check, reused between the moves
+    std::vector<int> contact_mesh_indices_;
+
+    // Wheels angle the meshes are currently rotated by
+    float wheels_angle_;
+
+    const GL::Mat4 center_translation_;
 
-    Accelerator accelerator_;
+    // Cache for GetMovementTransform
+    mutable GL::Mat4 movement_transform_;
+    mutable bool movement_transform_outdated_;
 
-    friend class Context; // access to private variables
     friend class Gui; // access to private variables
 };
 
@@ -0,0 +1,56 @@
+#include "car_state.hpp"
+
+namespace App {
+
+// Extern variables
+/* empty */
+
+void Step(CarState& state, const CarActions& actions, const float delta_time, const CarParams& params) {
+    if (actions[0]) {
+        state.speed = params.accelerator.IncreaseSpeed(state.speed, delta_time, true);
+        state.was_stopped = false;
+    }
+    if (actions[1]) {
+        state.speed = params.accelerator.IncreaseSpeed(state.speed, delta_time, false);
+        state.was_stopped = false;
+    }
+
+    // The car can't rotate in place, rotation speed depends on the move speed
+    if (state.speed != 0.0f) {
+        float rotate_speed = params.rotate_max_speed * state.speed / params.accelerator.GetMaxSpeed();
+        if (actions[2]) {
+            state.yaw += rotate_speed * delta_time;
+        }
+        if (actions[3]) {
+            state.yaw -= rotate_speed * delta_time;
+        }
+        // Keep the angles small, so there is no precision loss on long episodes
+        state.yaw = std::remainder(state.yaw, static_cast<float>(2.0 * APP_MATH_PI));
+    }
+
+    float distance = state.speed * delta_time;
+    state.x += std::sin(state.yaw) * distance;
+    state.z += std::cos(state.yaw) * distance;
+    state.wheels_angle = std::remainder(state.wheels_angle + params.wheels_rotate_speed * distance, 360.0f);
+
+    // Neither moving front nor back
+    if (!actions[0] && !actions[1]) {
+        state.speed = params.accelerator.DecreaseSpeed(state.speed, delta_time);
+    }
+}
+
+void Stop(CarState& state) {
+    state.speed = 0.0f;
+    state.was_stopped = true;
+}
+
+CarState Interpolate(const CarState& state, const CarState& next_state, const float fraction) {
+    CarState result = next_state;
+    result.x = state.x + (next_state.x - state.x) * fraction;
+    result.z = state.z + (next_state.z - state.z) * fraction;
+    result.yaw = std::remainder(state.yaw + std::remainder(next_state.yaw - state.yaw, static_cast<float>(2.0 * APP_MATH_PI)) * fraction, static_cast<float>(2.0 * APP_MATH_PI));
+    result.wheels_angle = std::remainder(state.wheels_angle + std::remainder(next_state.wheels_angle - state.wheels_angle, 360.0f) * fraction, 360.0f);
+    return result;
+}
+
+} // namespace App
\ No newline at end of file
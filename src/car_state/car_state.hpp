@@ -0,0 +1,57 @@
+#pragma once
+
+// STL
+#include <cmath>
+#include <type_traits>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <car_state/car_state_fwd.hpp>
+
+// LibSmartCar
+#include <accelerator/accelerator.hpp>
+
+namespace App {
+
+/*
+    Kinematic state of the car on the ground plane. It is plain data
+    without any GL resources, so it can be copied with memcpy, batched
+    and checkpointed, CarModel only reads it to draw the car
+*/
+struct CarState {
+    float x = 0.0f;
+    float z = 0.0f;
+    float yaw = 0.0f; // radians, the car looks along +z when yaw is zero
+    float speed = 0.0f;
+    float wheels_angle = 0.0f; // degrees
+    bool was_stopped = true; // check if car was stopped by collision
+};
+
+static_assert(std::is_trivially_copyable_v<CarState>, "CarState must stay trivially copyable");
+
+struct CarParams {
+    Accelerator accelerator;
+    float rotate_max_speed;
+    float wheels_rotate_speed;
+};
+
+/*
+    Advances the car by one tick: accelerates, steers, moves
+    and decelerates if neither front nor back is pressed.
+    Collisions are not checked there, see Stop
+*/
+void Step(CarState& state, const CarActions& actions, const float delta_time, const CarParams& params);
+
+// Car is stopped by collision
+void Stop(CarState& state);
+
+/*
+    Pose part of the way from one state to the next one (fraction in [0, 1]):
+    Step moves the car along a straight line, so the position is exact, angles take the shortest way.
+    Speed and the stop flag are taken from the next state
+*/
+CarState Interpolate(const CarState& state, const CarState& next_state, const float fraction);
+
+} // namespace App
\ No newline at end of file
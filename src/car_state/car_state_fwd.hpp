@@ -0,0 +1,17 @@
+#pragma once
+
+// STL
+#include <array>
+
+// Constants
+#include <constants/constants.hpp>
+
+namespace App {
+
+// Move front, move back, rotate left, rotate right
+using CarActions = std::array<bool, APP_CAR_ACTIONS_COUNT>;
+
+struct CarState;
+struct CarParams;
+
+} // namespace App
\ No newline at end of file
@@ -3,14 +3,18 @@
 // Incomplete type resolve
 #include <car_model/car_model.hpp>
 #include <skybox/skybox.hpp>
+#include <world/world.hpp>
 
 namespace App {
 
 // Extern variables
 extern const int APP_GL_VEC3_COMPONENTS_COUNT;
+extern const char* intersector_backends[static_cast<size_t>(IntersectorBackend::SIZE)];
+extern const float APP_OCCUPANCY_GRID_DEFAULT_CELL_SIZE;
+extern const int APP_COMPUTE_DEFAULT_TILE_SIZE;
 
 ConfigHandler::ConfigHandler(const std::string& filename, const std::string& config_files_folder)
-    : data_(std::make_shared<json>(json::parse(ReadFileData(filename, false)))), camera_case_selected_index_(-1) {
+    : data_(std::make_shared<json>(json::parse(ReadFileData(filename, false)))), camera_case_selected_index_(-1), lidar_config_({}), server_config_({}) {
     if (data_ == nullptr || data_->is_discarded()) {
         throw std::runtime_error("Error reading JSON file: " + filename);
     }
@@ -38,10 +42,25 @@ ConfigHandler::ConfigHandler(const std::string& filename, const std::string& con
     auto cameras_config_json = std::make_shared<json>(json::parse(ReadFileData(config_files_folder + cameras_config_filename, false)));
     SetCamerasConfigs(cameras_config_json);
 
+    // Lidar config is optional: the sensor is disabled without it
+    auto lidar_config_filename = FindString(data_, "lidar_config", true);
+    if (!lidar_config_filename.empty()) {
+        auto lidar_config_json = std::make_shared<json>(json::parse(ReadFileData(config_files_folder + lidar_config_filename, false)));
+        SetLidarConfig(lidar_config_json);
+    }
+
+    // Server config is optional: it is used only by the environment server
+    auto server_config_filename = FindString(data_, "server_config", true);
+    if (!server_config_filename.empty()) {
+        auto server_config_json = std::make_shared<json>(json::parse(ReadFileData(config_files_folder + server_config_filename, false)));
+        SetServerConfig(server_config_json);
+    }
+
     auto shaders_config_filename = FindString(data_, "shaders_config");
     auto shaders_config_json = std::make_shared<json>(json::parse(ReadFileData(config_files_folder + shaders_config_filename, false)));
     SetShaderHandler(shaders_config_json);
     context.shader_handler = shader_handler_;
+    context.compute_tile_sizes = compute_tile_sizes_;
 
     auto models_config_filename = FindString(data_, "models_config");
     auto models_config_json = std::make_shared<json>(json::parse(ReadFileData(config_files_folder + models_config_filename, false)));
@@ -61,17 +80,12 @@ ConfigHandler::ConfigHandler(const std::string& filename, const std::string& con
 
     ///// CAR /////
 
-    loading_timer.Start();
-
     auto car = FindObject(case_selected_, "car");
     auto car_model_name = FindString(car, "name");
 
-    auto car_model_config = std::dynamic_pointer_cast<Config::CarModelConfig>(models_configs_.at(car_model_name));
-    car_model_config->transform = FindTransform(car, true);
-    context.car_model = std::make_shared<App::CarModel>(*car_model_config);
+    car_model_config_ = *std::dynamic_pointer_cast<Config::CarModelConfig>(models_configs_.at(car_model_name));
+    car_model_config_.transform = FindTransform(car, true);
 
-    std::cout << "Model (" << car_model_name << ") loaded successfully in " << loading_timer.Stop<App::Timer::Milliseconds>() << " milliseconds" << std::endl;
-    
     ///// SKYBOX /////
 
     loading_timer.Start();
@@ -104,17 +118,51 @@ ConfigHandler::ConfigHandler(const std::string& filename, const std::string& con
 
     auto obstacles = FindArray(case_selected_, "obstacles");
     for (auto obstacle_object : obstacles) {
-        loading_timer.Start();
-
         auto obstacle_object_name = FindString(obstacle_object, "name");
         
         auto obstacle_config = *std::dynamic_pointer_cast<Config::CommonModelConfig>(models_configs_.at(obstacle_object_name));
         obstacle_config.transform = FindTransform(obstacle_object, true);
         
-        context.obstacles.push_back(std::make_shared<App::Model>(obstacle_config));
+        obstacles_configs_.push_back(obstacle_config);
+    }
+}
+
+void ConfigHandler::LoadWorld(World& world) const {
+    LoadCar(world);
+
+    App::Timer loading_timer;
 
-        std::cout << "Model (" << obstacle_object_name << ") loaded successfully in " << loading_timer.Stop<App::Timer::Milliseconds>() << " milliseconds" << std::endl;
+    ///// OBSTACLES /////
+
+    world.obstacles.clear();
+    for (auto&& obstacle_config : obstacles_configs_) {
+        loading_timer.Start();
+
+        world.obstacles.push_back(std::make_shared<App::Model>(obstacle_config));
+
+        std::cout << "Model (" << obstacle_config.name << ") loaded successfully in " << loading_timer.Stop<App::Timer::Milliseconds>() << " milliseconds" << std::endl;
+    }
+
+    // Obstacles are collected once, the registry keeps track of their transforms
+    world.obstacle_registry->Clear();
+    for (auto&& obstacle : world.obstacles) {
+        world.obstacle_registry->Add(obstacle.get());
     }
+    world.car_model->SetObstacleRegistry(world.obstacle_registry);
+}
+
+void ConfigHandler::LoadCar(World& world) const {
+    App::Timer loading_timer;
+
+    ///// CAR /////
+
+    loading_timer.Start();
+
+    world.car_model = std::make_shared<App::CarModel>(car_model_config_);
+
+    std::cout << "Model (" << car_model_config_.name << ") loaded successfully in " << loading_timer.Stop<App::Timer::Milliseconds>() << " milliseconds" << std::endl;
+
+    world.car_model->SetObstacleRegistry(world.obstacle_registry);
 }
 
 Config::WindowConfig ConfigHandler::GetWindowConfig() const {
@@ -136,6 +184,17 @@ Config::CameraConfig ConfigHandler::GetCameraConfig() const {
     return cameras_configs_[camera_case_selected_index_];
 }
 
+Config::LidarConfig ConfigHandler::GetLidarConfig() const {
+    return lidar_config_;
+}
+
+Config::ServerConfig ConfigHandler::GetServerConfig() const {
+    if (server_config_.socket_path.empty()) {
+        throw std::runtime_error("Server config is not set");
+    }
+    return server_config_;
+}
+
 ShaderHandler ConfigHandler::GetShaderHandler() const {
     return shader_handler_;
 }
@@ -161,10 +220,34 @@ void ConfigHandler::SetIntersectorsConfigs(const std::shared_ptr<json> intersect
             auto shader = FindObject(intersector_case, "shader");
             collision_intersector_config_.shader.compute_shader_name = FindString(shader, "default");
             collision_intersector_config_.enabled = FindBoolean(intersector_case, "enabled");
+            collision_intersector_config_.backend = FindIntersectorBackend(intersector_case, true);
+            collision_intersector_config_.readback_latency = FindInteger(intersector_case, "readback_latency", true, 0);
+            collision_intersector_config_.sensor_cache = false;
+            collision_intersector_config_.triangle_narrowphase = false;
+            collision_intersector_config_.oriented_narrowphase = FindBoolean(intersector_case, "oriented_narrowphase", true, false);
+            collision_intersector_config_.convex_hull_narrowphase = FindBoolean(intersector_case, "convex_hull_narrowphase", true, false);
+            collision_intersector_config_.penetration_depths = FindBoolean(intersector_case, "penetration_depths", true, false);
+            collision_intersector_config_.continuous = FindBoolean(intersector_case, "continuous", true, false);
         } else { // type == "RAY_INTERSECTION"
             auto shader = FindObject(intersector_case, "shader");
             ray_intersector_config_.shader.compute_shader_name = FindString(shader, "default");
             ray_intersector_config_.enabled = FindBoolean(intersector_case, "enabled");
+            ray_intersector_config_.backend = FindIntersectorBackend(intersector_case, true);
+            ray_intersector_config_.readback_latency = FindInteger(intersector_case, "readback_latency", true, 0);
+            ray_intersector_config_.sensor_cache = FindBoolean(intersector_case, "sensor_cache", true, true);
+            ray_intersector_config_.triangle_narrowphase = FindBoolean(intersector_case, "triangle_narrowphase", true, false);
+            ray_intersector_config_.oriented_narrowphase = false;
+            ray_intersector_config_.convex_hull_narrowphase = false;
+            ray_intersector_config_.penetration_depths = false;
+            ray_intersector_config_.continuous = false;
+
+            ray_intersector_config_.grid.cell_size = APP_OCCUPANCY_GRID_DEFAULT_CELL_SIZE;
+            ray_intersector_config_.grid.distance_field = false;
+            auto grid = FindObject(intersector_case, "grid", true);
+            if (grid != intersector_case->end()) {
+                ray_intersector_config_.grid.cell_size = FindFloat(grid, "cell_size", true, APP_OCCUPANCY_GRID_DEFAULT_CELL_SIZE);
+                ray_intersector_config_.grid.distance_field = FindBoolean(grid, "distance_field", true, false);
+            }
         }
     }
 };
@@ -206,6 +289,29 @@ void ConfigHandler::SetCamerasConfigs(const std::shared_ptr<json> cameras_json)
     }
 };
 
+void ConfigHandler::SetLidarConfig(const std::shared_ptr<json> lidar_json) {
+    lidar_config_.enabled = FindBoolean(lidar_json, "enabled");
+    lidar_config_.channels_count = FindInteger(lidar_json, "channels");
+    lidar_config_.horizontal_resolution = FindInteger(lidar_json, "horizontal_resolution");
+
+    auto elevation = FindObject(lidar_json, "elevation");
+    lidar_config_.min_elevation = FindFloat(elevation, "min");
+    lidar_config_.max_elevation = FindFloat(elevation, "max");
+
+    lidar_config_.range = FindFloat(lidar_json, "range");
+    lidar_config_.update_rate = FindFloat(lidar_json, "update_rate", true, 0.0f);
+    lidar_config_.position = FindVec3(lidar_json, "position", true);
+};
+
+void ConfigHandler::SetServerConfig(const std::shared_ptr<json> server_json) {
+    server_config_.socket_path = FindString(server_json, "socket_path");
+    server_config_.shared_memory_name = FindString(server_json, "shared_memory_name");
+    server_config_.environments_count = FindInteger(server_json, "environments_count");
+    if (server_config_.environments_count <= 0) {
+        throw std::runtime_error("Incorrect JSON: environments_count must be positive");
+    }
+};
+
 void ConfigHandler::SetShaderHandler(const std::shared_ptr<json> shaders_json) {
     auto shaders = ConvertToArray(shaders_json);
 
@@ -226,9 +332,15 @@ void ConfigHandler::SetShaderHandler(const std::shared_ptr<json> shaders_json) {
         const std::string compute = FindString(shader, "compute", true);
         if (!compute.empty()) {
             const std::string compute_path = APP_SHADER_DIR + compute;
-            GL::Shader compute_shader(GL::ShaderType::Compute, App::ReadFileData(compute_path, false));
 
-            shader_handler_[name] = std::make_shared<GL::Program>(compute_shader);
+            // Workgroup size is fixed at compile time, so it is chosen for the device here
+            const int tile_size = GetMaxComputeTileSize(FindInteger(shader, "tile_size", true, APP_COMPUTE_DEFAULT_TILE_SIZE));
+            const std::string compute_source = AddShaderDefine(App::ReadFileData(compute_path, false), "TILE_SIZE", tile_size);
+            GL::Shader compute_shader(GL::ShaderType::Compute, compute_source);
+
+            auto compute_program = std::make_shared<GL::Program>(compute_shader);
+            compute_tile_sizes_[name] = GetComputeTileSize(*compute_program);
+            shader_handler_[name] = compute_program;
         }
     }
 }
@@ -531,6 +643,19 @@ const GL::Vec3 ConfigHandler::FindVec3(const json_object& parent, const std::str
     return result;
 }
 
+const IntersectorBackend ConfigHandler::FindIntersectorBackend(const json_object& parent, bool can_skip, IntersectorBackend default_value) const {
+    auto backend_name = FindString(parent, "backend", can_skip);
+    if (backend_name.empty()) {
+        return default_value;
+    }
+    for (int backend_index = 0; backend_index < static_cast<int>(IntersectorBackend::SIZE); ++backend_index) {
+        if (backend_name == intersector_backends[backend_index]) {
+            return static_cast<IntersectorBackend>(backend_index);
+        }
+    }
+    throw std::runtime_error("Incorrect JSON format: Unknown intersector backend " + backend_name);
+}
+
 const Transform ConfigHandler::FindTransform(std::shared_ptr<json> parent, bool can_skip, Transform default_value) const {
     Transform result{};
 
@@ -22,6 +22,7 @@ using json_object = nlohmann::detail::iter_impl<json>;
 // Incomplete type resolve
 #include <car_model/car_model_fwd.hpp>
 #include <skybox/skybox_fwd.hpp>
+#include <world/world_fwd.hpp>
 
 namespace App {
 
@@ -55,6 +56,35 @@ struct WindowConfig {
 struct IntersectorConfig {
     Shader shader;
     bool enabled;
+    IntersectorBackend backend;
+    int readback_latency; // GPU backend only, in Intersect calls
+    bool sensor_cache; // rays only
+    bool triangle_narrowphase; // rays only, CPU_SIMD backend
+    bool oriented_narrowphase; // collisions only, CPU backends
+    bool convex_hull_narrowphase; // collisions only, CPU backends
+    bool penetration_depths; // collisions only, with the convex hull narrowphase
+    bool continuous; // collisions only
+    struct Grid {
+        float cell_size;
+        bool distance_field;
+    } grid;
+};
+
+struct LidarConfig {
+    bool enabled;
+    int channels_count;
+    int horizontal_resolution;
+    float min_elevation; // degrees
+    float max_elevation; // degrees
+    float range;
+    float update_rate; // scans per second, zero scans on every step
+    GL::Vec3 position; // car space
+};
+
+struct ServerConfig {
+    std::string socket_path;
+    std::string shared_memory_name;
+    int environments_count;
 };
 
 struct CameraConfig {
@@ -123,12 +153,22 @@ public:
     Config::IntersectorConfig GetCollisionIntersectorConfig() const;
     Config::IntersectorConfig GetRayIntersectorConfig() const;
     Config::CameraConfig GetCameraConfig() const;
+    Config::LidarConfig GetLidarConfig() const;
+    Config::ServerConfig GetServerConfig() const;
     ShaderHandler GetShaderHandler() const;
 
+    // Loads car and obstacles of the selected case, may be called for several worlds
+    void LoadWorld(World& world) const;
+
+    // Loads the car only, it senses the obstacles already in the world registry
+    void LoadCar(World& world) const;
+
 private:
     void SetWindowConfig(const std::shared_ptr<json> window_json);
     void SetIntersectorsConfigs(const std::shared_ptr<json> intersector_json);
     void SetCamerasConfigs(const std::shared_ptr<json> cameras_json);
+    void SetLidarConfig(const std::shared_ptr<json> lidar_json);
+    void SetServerConfig(const std::shared_ptr<json> server_json);
     void SetShaderHandler(const std::shared_ptr<json> shaders_json);
     void SetModelsConfigs(const std::shared_ptr<json> models_json);
 
@@ -159,6 +199,8 @@ private:
     const GL::Vec3 FindVec3(std::shared_ptr<json> parent, const std::string& vector_name, bool can_skip = false, GL::Vec3 default_value = {}) const;
     const GL::Vec3 FindVec3(const json_object& parent, const std::string& vector_name, bool can_skip = false, GL::Vec3 default_value = {}) const;
 
+    const IntersectorBackend FindIntersectorBackend(const json_object& parent, bool can_skip = false, IntersectorBackend default_value = IntersectorBackend::GPU) const;
+
     const Transform FindTransform(std::shared_ptr<json> parent, bool can_skip = false, Transform default_value = {}) const;
     const Transform FindTransform(const json_object& parent, bool can_skip = false, Transform default_value = {}) const;
 
@@ -170,11 +212,18 @@ private:
 
     Config::IntersectorConfig collision_intersector_config_;
     Config::IntersectorConfig ray_intersector_config_;
+    Config::LidarConfig lidar_config_;
 
     std::vector<Config::CameraConfig> cameras_configs_;
+    Config::ServerConfig server_config_;
     ShaderHandler shader_handler_;
+    ComputeTileSizes compute_tile_sizes_;
 
     std::map<std::string, std::shared_ptr<Config::BaseModelConfig>> models_configs_;
+
+    // Selected case models, which are loaded separately for every world
+    Config::CarModelConfig car_model_config_;
+    std::vector<Config::CommonModelConfig> obstacles_configs_;
 };
 
 } // namespace App
\ No newline at end of file
@@ -10,7 +10,9 @@ struct Shader;
 
 struct WindowConfig;
 struct IntersectorConfig;
+struct LidarConfig;
 struct CameraConfig;
+struct ServerConfig;
 
 struct BaseModelConfig;
 struct CommonModelConfig;
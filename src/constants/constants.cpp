@@ -69,10 +69,46 @@ const int APP_NORMAL_TEXTURE_UNIT = 3;
 // Car
 const GL::Vec3 APP_CAR_WHEELS_ROTATION_AXIS = GL::Vec3(1.0f, 0.0f, 0.0f);
 const float APP_CAR_SPEED_EPS = 0.05f;
+const int APP_CAR_HULL_CONTACT_MAX_ITERATIONS = 16;
 
 // Intersector
+const char* intersector_backends[static_cast<size_t>(IntersectorBackend::SIZE)] = { "GPU", "CPU_SIMD", "CPU_SWEEP", "GRID" };
+
 const int APP_INTERSECTOR_NUM_GROUPS_Z_COUNT = 1;
-const float APP_INTERSECTOR_INTERSECTION_FOUND = 1.0f;
-const float APP_INTERSECTOR_INTERSECTION_NOT_FOUND = 0.0f;
+const int APP_INTERSECTOR_MAX_COLLISIONS_COUNT = 1024;
+const float APP_INTERSECTOR_SAT_PARALLEL_EPS = 1e-6f;
+const float APP_INTERSECTOR_CONTACT_SKIN = 1e-3f;
+const int APP_COMPUTE_DEFAULT_TILE_SIZE = 64;
+const size_t APP_RAY_INTERSECTOR_MIN_CARS_PER_THREAD = 8;
+const float APP_RAY_INTERSECTOR_CACHE_POSE_TOLERANCE = 1e-5f;
+const float APP_RAY_INTERSECTOR_CACHE_MAX_SHIFT = 0.5f;
+
+// Lidar
+const size_t APP_LIDAR_MIN_PACKETS_PER_THREAD = 64;
+
+// BVH
+const int APP_BVH_MAX_LEAF_SIZE = 4;
+const int APP_BVH_MAX_SAH_DEPTH = 24; // deeper nodes are split by median, so the tree depth stays below the traversal stack size
+
+// Convex hull
+const float APP_CONVEX_HULL_RELATIVE_EPS = 1e-5f;
+const int APP_GJK_MAX_ITERATIONS = 32;
+const float APP_GJK_RELATIVE_TOLERANCE = 1e-4f;
+const int APP_EPA_MAX_ITERATIONS = 64;
+const float APP_EPA_RELATIVE_TOLERANCE = 1e-3f;
+
+// GPU buffers
+const size_t APP_PERSISTENT_STORAGE_BUFFER_MIN_CAPACITY = 256;
+const GLuint64 APP_GPU_FENCE_WAIT_TIMEOUT = 1000000;
+
+// Occupancy grid
+const float APP_OCCUPANCY_GRID_DEFAULT_CELL_SIZE = 0.1f;
+const int APP_OCCUPANCY_GRID_MAX_CELLS_COUNT = 1 << 26;
+
+// Environment server
+const unsigned int APP_ENV_SERVER_SHARED_MEMORY_MAGIC = 0x53434152; // "SCAR"
+const unsigned int APP_ENV_SERVER_SHARED_MEMORY_VERSION = 1;
+const unsigned int APP_ENV_SERVER_SHARED_MEMORY_ALIGNMENT = 64;
+const unsigned int APP_ENV_SERVER_ALL_ENVIRONMENTS = 0xFFFFFFFF;
 
 }
\ No newline at end of file
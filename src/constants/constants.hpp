@@ -48,6 +48,15 @@ constexpr int APP_CUBEMAP_TEXTURES_COUNT = 6;
 // Ray intersector
 constexpr int APP_RAY_INTERSECTOR_RAYS_COUNT = 121;
 
+// GPU readback
+// WARNING: readback latency has to be less than the ring size
+constexpr int APP_INTERSECTOR_READBACK_RING_SIZE = 3;
+
+// BVH
+// WARNING: stack has to be deeper than the tree, see APP_BVH_MAX_SAH_DEPTH
+constexpr int APP_BVH_BINS_COUNT = 12;
+constexpr int APP_BVH_TRAVERSAL_STACK_SIZE = 64;
+
 // For DQN algorithm
 constexpr int APP_CAR_STATE_PARAMETERS_COUNT = APP_RAY_INTERSECTOR_RAYS_COUNT + 4;
 constexpr int APP_CAR_ACTIONS_COUNT = 4;
@@ -127,10 +136,60 @@ extern const int APP_NORMAL_TEXTURE_UNIT;
 // Car
 extern const GL::Vec3 APP_CAR_WHEELS_ROTATION_AXIS;
 extern const float APP_CAR_SPEED_EPS;
+extern const int APP_CAR_HULL_CONTACT_MAX_ITERATIONS; // conservative advancement after the box contact stops after that many steps
+
+// Car meshes are checked for collisions group by group, a group is skipped if its bounds don't touch the obstacle
+enum class CarCollisionGroup: int {
+    BODY = 0,
+    WHEELS,
+    SIZE
+};
 
 // Intersector
+enum class IntersectorBackend: int {
+    GPU = 0,
+    CPU_SIMD,
+    CPU_SWEEP,
+    GRID, // rays only
+    SIZE
+};
+extern const char* intersector_backends[static_cast<size_t>(IntersectorBackend::SIZE)];
+
 extern const int APP_INTERSECTOR_NUM_GROUPS_Z_COUNT;
-extern const float APP_INTERSECTOR_INTERSECTION_FOUND;
-extern const float APP_INTERSECTOR_INTERSECTION_NOT_FOUND;
+extern const int APP_INTERSECTOR_MAX_COLLISIONS_COUNT;
+extern const float APP_INTERSECTOR_SAT_PARALLEL_EPS; // added to the rotation terms, so nearly parallel edges don't give false separating axes
+extern const float APP_INTERSECTOR_CONTACT_SKIN; // swept car parts stop that far before the contact, so they don't touch obstacles
+extern const int APP_COMPUTE_DEFAULT_TILE_SIZE;
+extern const size_t APP_RAY_INTERSECTOR_MIN_CARS_PER_THREAD;
+extern const float APP_RAY_INTERSECTOR_CACHE_POSE_TOLERANCE;
+extern const float APP_RAY_INTERSECTOR_CACHE_MAX_SHIFT;
+
+// Lidar
+extern const size_t APP_LIDAR_MIN_PACKETS_PER_THREAD;
+
+// BVH
+extern const int APP_BVH_MAX_LEAF_SIZE;
+extern const int APP_BVH_MAX_SAH_DEPTH;
+
+// Convex hull
+extern const float APP_CONVEX_HULL_RELATIVE_EPS; // of the mesh size, closer points are treated as lying on the hull
+extern const int APP_GJK_MAX_ITERATIONS;
+extern const float APP_GJK_RELATIVE_TOLERANCE;
+extern const int APP_EPA_MAX_ITERATIONS;
+extern const float APP_EPA_RELATIVE_TOLERANCE;
+
+// GPU buffers
+extern const size_t APP_PERSISTENT_STORAGE_BUFFER_MIN_CAPACITY;
+extern const GLuint64 APP_GPU_FENCE_WAIT_TIMEOUT; // nanoseconds
+
+// Occupancy grid
+extern const float APP_OCCUPANCY_GRID_DEFAULT_CELL_SIZE;
+extern const int APP_OCCUPANCY_GRID_MAX_CELLS_COUNT;
+
+// Environment server
+extern const unsigned int APP_ENV_SERVER_SHARED_MEMORY_MAGIC;
+extern const unsigned int APP_ENV_SERVER_SHARED_MEMORY_VERSION;
+extern const unsigned int APP_ENV_SERVER_SHARED_MEMORY_ALIGNMENT;
+extern const unsigned int APP_ENV_SERVER_ALL_ENVIRONMENTS;
 
 } // namespace App
\ No newline at end of file
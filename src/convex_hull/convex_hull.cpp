@@ -0,0 +1,607 @@
+#include "convex_hull.hpp"
+
+// STL
+#define NOMINMAX
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+namespace App {
+
+// Extern variables
+extern const float APP_CONVEX_HULL_RELATIVE_EPS;
+extern const int APP_GJK_MAX_ITERATIONS;
+extern const float APP_GJK_RELATIVE_TOLERANCE;
+extern const int APP_EPA_MAX_ITERATIONS;
+extern const float APP_EPA_RELATIVE_TOLERANCE;
+
+// Counter-clockwise seen from the outside
+struct HullFace {
+    int vertices[3];
+    GL::Vec3 normal;
+    float offset;
+    std::vector<int> outside_points;
+    bool is_removed;
+};
+
+static HullFace MakeFace(const std::vector<GL::Vec3>& points, const int a, const int b, const int c) {
+    HullFace face{{a, b, c}, GL::Vec3{}, 0.0f, {}, false};
+    GL::Vec3 normal = (points[b] - points[a]).Cross(points[c] - points[a]);
+    float length = normal.Length();
+    if (length > 0.0f) {
+        face.normal = normal / length;
+    }
+    face.offset = face.normal.Dot(points[a]);
+    return face;
+}
+
+static float GetFaceDistance(const HullFace& face, const GL::Vec3& point) {
+    return face.normal.Dot(point) - face.offset;
+}
+
+// Every outside point goes to the face it is the farthest from
+static void AssignOutsidePoints(const std::vector<GL::Vec3>& points, const std::vector<int>& candidates, const int skipped_point,
+    std::vector<HullFace>& faces, const size_t first_face, const float eps) {
+    for (auto point_index : candidates) {
+        if (point_index == skipped_point) {
+            continue;
+        }
+        float best_distance = eps;
+        size_t best_face = faces.size();
+        for (size_t face_index = first_face; face_index < faces.size(); ++face_index) {
+            float distance = GetFaceDistance(faces[face_index], points[point_index]);
+            if (distance > best_distance) {
+                best_distance = distance;
+                best_face = face_index;
+            }
+        }
+        if (best_face < faces.size()) {
+            faces[best_face].outside_points.push_back(point_index);
+        }
+    }
+}
+
+// World space support of the placed hull, the direction is moved into the mesh space by the transposed linear part
+static GL::Vec3 GetInstanceSupport(const ConvexHullInstance& instance, const GL::Vec3& direction) {
+    const float* m = instance.mesh_to_world.m;
+    GL::Vec3 mesh_direction{
+        m[0] * direction.X + m[1] * direction.Y + m[2] * direction.Z,
+        m[4] * direction.X + m[5] * direction.Y + m[6] * direction.Z,
+        m[8] * direction.X + m[9] * direction.Y + m[10] * direction.Z
+    };
+    return instance.mesh_to_world * instance.hull->GetSupport(mesh_direction);
+}
+
+// Support of the Minkowski difference first - second
+static GL::Vec3 GetDifferenceSupport(const ConvexHullInstance& first, const ConvexHullInstance& second, const GL::Vec3& direction) {
+    return GetInstanceSupport(first, direction) - GetInstanceSupport(second, direction * -1.0f);
+}
+
+/*
+    Closest to the origin points of the simplices (Ericson, Real-Time Collision Detection, 5.1).
+    Vertices not needed for the closest point are dropped, so the simplex stays minimal
+*/
+static GL::Vec3 ReduceSegment(GL::Vec3* simplex, int& size) {
+    GL::Vec3 a = simplex[0];
+    GL::Vec3 ab = simplex[1] - a;
+    float t = -a.Dot(ab);
+    if (t <= 0.0f) {
+        size = 1;
+        return a;
+    }
+    float length_squared = ab.Dot(ab);
+    if (t >= length_squared) {
+        simplex[0] = simplex[1];
+        size = 1;
+        return simplex[0];
+    }
+    return a + ab * (t / length_squared);
+}
+
+static GL::Vec3 ReduceTriangle(GL::Vec3* simplex, int& size) {
+    GL::Vec3 a = simplex[0];
+    GL::Vec3 b = simplex[1];
+    GL::Vec3 c = simplex[2];
+    GL::Vec3 ab = b - a;
+    GL::Vec3 ac = c - a;
+
+    float d1 = -ab.Dot(a);
+    float d2 = -ac.Dot(a);
+    if ((d1 <= 0.0f) && (d2 <= 0.0f)) {
+        size = 1;
+        return a;
+    }
+    float d3 = -ab.Dot(b);
+    float d4 = -ac.Dot(b);
+    if ((d3 >= 0.0f) && (d4 <= d3)) {
+        simplex[0] = b;
+        size = 1;
+        return b;
+    }
+    float vc = d1 * d4 - d3 * d2;
+    if ((vc <= 0.0f) && (d1 >= 0.0f) && (d3 <= 0.0f)) {
+        size = 2;
+        return a + ab * (d1 / (d1 - d3));
+    }
+    float d5 = -ab.Dot(c);
+    float d6 = -ac.Dot(c);
+    if ((d6 >= 0.0f) && (d5 <= d6)) {
+        simplex[0] = c;
+        size = 1;
+        return c;
+    }
+    float vb = d5 * d2 - d1 * d6;
+    if ((vb <= 0.0f) && (d2 >= 0.0f) && (d6 <= 0.0f)) {
+        simplex[1] = c;
+        size = 2;
+        return a + ac * (d2 / (d2 - d6));
+    }
+    float va = d3 * d6 - d5 * d4;
+    if ((va <= 0.0f) && (d4 - d3 >= 0.0f) && (d5 - d6 >= 0.0f)) {
+        simplex[0] = c;
+        size = 2;
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+    float denominator = 1.0f / (va + vb + vc);
+    size = 3;
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+// Returns false if the origin is inside, then the simplex is kept whole
+static bool ReduceTetrahedron(GL::Vec3* simplex, int& size, GL::Vec3& closest_point) {
+    static const int faces[4][4] = {{0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+
+    bool is_inside = true;
+    float best_distance = std::numeric_limits<float>::infinity();
+    GL::Vec3 best_simplex[3];
+    int best_size = 0;
+    for (const auto& face : faces) {
+        const GL::Vec3& a = simplex[face[0]];
+        GL::Vec3 normal = (simplex[face[1]] - a).Cross(simplex[face[2]] - a);
+        float origin_side = -normal.Dot(a);
+        float opposite_side = normal.Dot(simplex[face[3]] - a);
+        // Flat tetrahedra have every face "visible", so their closest point is still found
+        if (origin_side * opposite_side > 0.0f) {
+            continue;
+        }
+        is_inside = false;
+
+        GL::Vec3 face_simplex[3] = {simplex[face[0]], simplex[face[1]], simplex[face[2]]};
+        int face_size = 3;
+        GL::Vec3 point = ReduceTriangle(face_simplex, face_size);
+        float distance = point.Dot(point);
+        if (distance < best_distance) {
+            best_distance = distance;
+            closest_point = point;
+            std::copy(face_simplex, face_simplex + face_size, best_simplex);
+            best_size = face_size;
+        }
+    }
+    if (is_inside) {
+        return false;
+    }
+    std::copy(best_simplex, best_simplex + best_size, simplex);
+    size = best_size;
+    return true;
+}
+
+/*
+    GJK stopped on the boundary keeps fewer vertices, EPA needs a tetrahedron around the origin,
+    so it is completed by the supports across the current simplex. Returns false if the difference is flat
+*/
+static bool CompleteTetrahedron(const ConvexHullInstance& first, const ConvexHullInstance& second, GL::Vec3* simplex, int& size) {
+    static const GL::Vec3 axes[3] = {GL::Vec3{1.0f, 0.0f, 0.0f}, GL::Vec3{0.0f, 1.0f, 0.0f}, GL::Vec3{0.0f, 0.0f, 1.0f}};
+    float max_vertex_distance = 0.0f;
+    for (int index = 0; index < size; ++index) {
+        max_vertex_distance = (std::max)(max_vertex_distance, simplex[index].Dot(simplex[index]));
+    }
+    const float eps = APP_GJK_RELATIVE_TOLERANCE * std::sqrt(max_vertex_distance);
+
+    for (int axis = 0; (axis < 3) && (size == 1); ++axis) {
+        for (float sign : {1.0f, -1.0f}) {
+            GL::Vec3 support = GetDifferenceSupport(first, second, axes[axis] * sign);
+            if ((support - simplex[0]).Length() > eps) {
+                simplex[size++] = support;
+                break;
+            }
+        }
+    }
+    for (int axis = 0; (axis < 3) && (size == 2); ++axis) {
+        GL::Vec3 edge = (simplex[1] - simplex[0]).Normal();
+        GL::Vec3 direction = edge.Cross(axes[axis]);
+        if (direction.Dot(direction) < 0.25f) {
+            continue;
+        }
+        for (float sign : {1.0f, -1.0f}) {
+            GL::Vec3 support = GetDifferenceSupport(first, second, direction * sign);
+            if ((support - simplex[0]).Cross(edge).Length() > eps) {
+                simplex[size++] = support;
+                break;
+            }
+        }
+    }
+    if (size == 3) {
+        GL::Vec3 normal = (simplex[1] - simplex[0]).Cross(simplex[2] - simplex[0]);
+        if (!(normal.Length() > 0.0f)) {
+            return false;
+        }
+        normal = normal.Normal();
+        for (float sign : {1.0f, -1.0f}) {
+            GL::Vec3 support = GetDifferenceSupport(first, second, normal * sign);
+            if (std::abs((support - simplex[0]).Dot(normal)) > eps) {
+                simplex[size++] = support;
+                break;
+            }
+        }
+    }
+    return size == 4;
+}
+
+static bool MakePolytopeFace(const std::vector<GL::Vec3>& vertices, const int a, const int b, const int c, PolytopeFace& face) {
+    GL::Vec3 normal = (vertices[b] - vertices[a]).Cross(vertices[c] - vertices[a]);
+    float length = normal.Length();
+    if (!(length > 0.0f)) {
+        return false;
+    }
+    face = PolytopeFace{{a, b, c}, normal / length, 0.0f};
+    face.distance = (std::max)(0.0f, face.normal.Dot(vertices[a]));
+    return true;
+}
+
+/*
+    Expanding polytope: starts from the GJK tetrahedron around the origin and grows towards the closest face,
+    until the support along its normal doesn't get any farther
+*/
+static float ComputePenetration(const ConvexHullInstance& first, const ConvexHullInstance& second, const GL::Vec3* tetrahedron,
+    PenetrationBuffers& buffers, GL::Vec3& normal) {
+    std::vector<GL::Vec3>& vertices = buffers.vertices;
+    std::vector<PolytopeFace>& faces = buffers.faces;
+    std::vector<std::pair<int, int>>& edges = buffers.edges;
+    vertices.assign(tetrahedron, tetrahedron + 4);
+    faces.clear();
+    static const int tetrahedron_faces[4][4] = {{0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+    for (const auto& indices : tetrahedron_faces) {
+        // Outward normals look away from the fourth vertex
+        int a = indices[0];
+        int b = indices[1];
+        int c = indices[2];
+        if ((vertices[b] - vertices[a]).Cross(vertices[c] - vertices[a]).Dot(vertices[indices[3]] - vertices[a]) > 0.0f) {
+            std::swap(b, c);
+        }
+        PolytopeFace face;
+        if (!MakePolytopeFace(vertices, a, b, c, face)) {
+            normal = GL::Vec3{};
+            return 0.0f;
+        }
+        faces.push_back(face);
+    }
+
+    size_t closest_face = 0;
+    for (int iteration = 0; iteration < APP_EPA_MAX_ITERATIONS; ++iteration) {
+        closest_face = 0;
+        for (size_t face_index = 1; face_index < faces.size(); ++face_index) {
+            if (faces[face_index].distance < faces[closest_face].distance) {
+                closest_face = face_index;
+            }
+        }
+        const PolytopeFace face = faces[closest_face];
+        GL::Vec3 support = GetDifferenceSupport(first, second, face.normal);
+        float support_distance = support.Dot(face.normal);
+        if (support_distance - face.distance <= APP_EPA_RELATIVE_TOLERANCE * (std::max)(support_distance, std::numeric_limits<float>::min())) {
+            break;
+        }
+
+        // Faces seen from the new vertex are removed, edges shared by two of them are not on the horizon
+        int new_vertex = static_cast<int>(vertices.size());
+        vertices.push_back(support);
+        edges.clear();
+        for (size_t face_index = 0; face_index < faces.size();) {
+            const PolytopeFace& visible_face = faces[face_index];
+            if (visible_face.normal.Dot(support - vertices[visible_face.vertices[0]]) <= 0.0f) {
+                ++face_index;
+                continue;
+            }
+            for (int edge = 0; edge < 3; ++edge) {
+                std::pair<int, int> current{visible_face.vertices[edge], visible_face.vertices[(edge + 1) % 3]};
+                auto reversed = std::find(edges.begin(), edges.end(), std::make_pair(current.second, current.first));
+                if (reversed != edges.end()) {
+                    edges.erase(reversed);
+                } else {
+                    edges.push_back(current);
+                }
+            }
+            faces[face_index] = faces.back();
+            faces.pop_back();
+        }
+        for (const auto& edge : edges) {
+            PolytopeFace new_face;
+            if (!MakePolytopeFace(vertices, edge.first, edge.second, new_vertex, new_face)) {
+                // Numerically flat face, the last closest face is the best estimate
+                normal = face.normal;
+                return face.distance;
+            }
+            faces.push_back(new_face);
+        }
+        if (faces.empty()) {
+            normal = face.normal;
+            return face.distance;
+        }
+    }
+    closest_face = 0;
+    for (size_t face_index = 1; face_index < faces.size(); ++face_index) {
+        if (faces[face_index].distance < faces[closest_face].distance) {
+            closest_face = face_index;
+        }
+    }
+    normal = faces[closest_face].normal;
+    return faces[closest_face].distance;
+}
+
+static void ComputeContactPenetration(const ConvexHullInstance& first, const ConvexHullInstance& second, const GL::Vec3* tetrahedron,
+    PenetrationBuffers& buffers, ConvexHullsContact& contact) {
+    GL::Vec3 normal;
+    contact.penetration_depth = ComputePenetration(first, second, tetrahedron, buffers, normal);
+    if (normal.Dot(normal) > 0.0f) {
+        contact.direction = normal * -1.0f;
+    }
+}
+
+ConvexHull::ConvexHull(const std::vector<GL::Vertex>& vertices) {
+    std::vector<GL::Vec3> points;
+    points.reserve(vertices.size());
+    for (const auto& vertex : vertices) {
+        points.push_back(vertex.Pos);
+    }
+    if (!BuildQuickhull(points)) {
+        KeepPoints(points);
+    }
+}
+
+GL::Vec3 ConvexHull::GetSupport(const GL::Vec3& direction) const {
+    size_t best_index = 0;
+    float best_projection = -std::numeric_limits<float>::infinity();
+    for (size_t index = 0; index < x_.size(); ++index) {
+        float projection = x_[index] * direction.X + y_[index] * direction.Y + z_[index] * direction.Z;
+        if (projection > best_projection) {
+            best_projection = projection;
+            best_index = index;
+        }
+    }
+    return GetVertex(best_index);
+}
+
+bool ConvexHull::BuildQuickhull(const std::vector<GL::Vec3>& points) {
+    if (points.size() < 4) {
+        return false;
+    }
+
+    // Initial tetrahedron: the farthest pair of the axis extremes, the point farthest from their line and from their plane
+    int extremes[6] = {0, 0, 0, 0, 0, 0};
+    for (int index = 1; index < static_cast<int>(points.size()); ++index) {
+        const float coordinates[3] = {points[index].X, points[index].Y, points[index].Z};
+        for (int axis = 0; axis < 3; ++axis) {
+            const float min_coordinates[3] = {points[extremes[2 * axis]].X, points[extremes[2 * axis]].Y, points[extremes[2 * axis]].Z};
+            const float max_coordinates[3] = {points[extremes[2 * axis + 1]].X, points[extremes[2 * axis + 1]].Y, points[extremes[2 * axis + 1]].Z};
+            if (coordinates[axis] < min_coordinates[axis]) {
+                extremes[2 * axis] = index;
+            }
+            if (coordinates[axis] > max_coordinates[axis]) {
+                extremes[2 * axis + 1] = index;
+            }
+        }
+    }
+    float size = (std::max)({
+        points[extremes[1]].X - points[extremes[0]].X,
+        points[extremes[3]].Y - points[extremes[2]].Y,
+        points[extremes[5]].Z - points[extremes[4]].Z
+    });
+    const float eps = APP_CONVEX_HULL_RELATIVE_EPS * size;
+    if (!(eps > 0.0f)) {
+        return false;
+    }
+
+    int base[4] = {extremes[0], extremes[1], 0, 0};
+    float best_distance = 0.0f;
+    for (int first = 0; first < 6; ++first) {
+        for (int second = first + 1; second < 6; ++second) {
+            GL::Vec3 delta = points[extremes[second]] - points[extremes[first]];
+            float distance = delta.Dot(delta);
+            if (distance > best_distance) {
+                best_distance = distance;
+                base[0] = extremes[first];
+                base[1] = extremes[second];
+            }
+        }
+    }
+    GL::Vec3 line = (points[base[1]] - points[base[0]]).Normal();
+    best_distance = 0.0f;
+    for (int index = 0; index < static_cast<int>(points.size()); ++index) {
+        float distance = (points[index] - points[base[0]]).Cross(line).Length();
+        if (distance > best_distance) {
+            best_distance = distance;
+            base[2] = index;
+        }
+    }
+    if (best_distance <= eps) {
+        return false;
+    }
+    GL::Vec3 plane = (points[base[1]] - points[base[0]]).Cross(points[base[2]] - points[base[0]]).Normal();
+    best_distance = 0.0f;
+    for (int index = 0; index < static_cast<int>(points.size()); ++index) {
+        float distance = std::abs((points[index] - points[base[0]]).Dot(plane));
+        if (distance > best_distance) {
+            best_distance = distance;
+            base[3] = index;
+        }
+    }
+    if (best_distance <= eps) {
+        return false;
+    }
+
+    GL::Vec3 centroid = (points[base[0]] + points[base[1]] + points[base[2]] + points[base[3]]) * 0.25f;
+    std::vector<HullFace> faces;
+    static const int tetrahedron_faces[4][3] = {{0, 1, 2}, {0, 2, 3}, {0, 3, 1}, {1, 3, 2}};
+    for (const auto& indices : tetrahedron_faces) {
+        HullFace face = MakeFace(points, base[indices[0]], base[indices[1]], base[indices[2]]);
+        if (GetFaceDistance(face, centroid) > 0.0f) {
+            face = MakeFace(points, base[indices[0]], base[indices[2]], base[indices[1]]);
+        }
+        faces.push_back(face);
+    }
+    std::vector<int> candidates(points.size());
+    for (int index = 0; index < static_cast<int>(points.size()); ++index) {
+        candidates[index] = index;
+    }
+    AssignOutsidePoints(points, candidates, -1, faces, 0, eps);
+
+    // New faces are appended, so a single pass reaches every face with outside points
+    std::set<std::pair<int, int>> visible_edges;
+    std::vector<std::pair<int, int>> horizon;
+    for (size_t face_index = 0; face_index < faces.size(); ++face_index) {
+        if (faces[face_index].is_removed || faces[face_index].outside_points.empty()) {
+            continue;
+        }
+        int eye = faces[face_index].outside_points.front();
+        float eye_distance = GetFaceDistance(faces[face_index], points[eye]);
+        for (auto point_index : faces[face_index].outside_points) {
+            float distance = GetFaceDistance(faces[face_index], points[point_index]);
+            if (distance > eye_distance) {
+                eye_distance = distance;
+                eye = point_index;
+            }
+        }
+
+        // Faces seen from the eye are removed, the edges between them and the rest of the hull make the horizon
+        visible_edges.clear();
+        candidates.clear();
+        for (auto& face : faces) {
+            if (face.is_removed || (GetFaceDistance(face, points[eye]) <= eps)) {
+                continue;
+            }
+            face.is_removed = true;
+            for (int edge = 0; edge < 3; ++edge) {
+                visible_edges.emplace(face.vertices[edge], face.vertices[(edge + 1) % 3]);
+            }
+            candidates.insert(candidates.end(), face.outside_points.begin(), face.outside_points.end());
+            face.outside_points.clear();
+            face.outside_points.shrink_to_fit();
+        }
+        horizon.clear();
+        for (const auto& edge : visible_edges) {
+            if (visible_edges.count(std::make_pair(edge.second, edge.first)) == 0) {
+                horizon.push_back(edge);
+            }
+        }
+
+        size_t first_new_face = faces.size();
+        for (const auto& edge : horizon) {
+            faces.push_back(MakeFace(points, edge.first, edge.second, eye));
+        }
+        AssignOutsidePoints(points, candidates, eye, faces, first_new_face, eps);
+    }
+
+    std::vector<int> hull_points;
+    for (const auto& face : faces) {
+        if (!face.is_removed) {
+            hull_points.insert(hull_points.end(), face.vertices, face.vertices + 3);
+        }
+    }
+    std::sort(hull_points.begin(), hull_points.end());
+    hull_points.erase(std::unique(hull_points.begin(), hull_points.end()), hull_points.end());
+
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    for (auto point_index : hull_points) {
+        x_.push_back(points[point_index].X);
+        y_.push_back(points[point_index].Y);
+        z_.push_back(points[point_index].Z);
+    }
+    return true;
+}
+
+void ConvexHull::KeepPoints(const std::vector<GL::Vec3>& points) {
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    for (const auto& point : points) {
+        x_.push_back(point.X);
+        y_.push_back(point.Y);
+        z_.push_back(point.Z);
+    }
+}
+
+ConvexHullsContact IntersectConvexHulls(const ConvexHullInstance& first, const ConvexHullInstance& second,
+    const GL::Vec3& initial_direction, PenetrationBuffers* penetration_buffers) {
+    GL::Vec3 direction = (initial_direction.Dot(initial_direction) > 0.0f) ? initial_direction.Normal() : GL::Vec3{1.0f, 0.0f, 0.0f};
+    ConvexHullsContact contact{false, 0.0f, 0.0f, direction};
+    if (first.hull->IsEmpty() || second.hull->IsEmpty()) {
+        contact.distance = std::numeric_limits<float>::infinity();
+        return contact;
+    }
+
+    // Closest point of the first - second difference is the support along the direction between the hulls
+    GL::Vec3 simplex[4] = {GetDifferenceSupport(first, second, direction)};
+    int size = 1;
+    GL::Vec3 closest_point = simplex[0];
+
+    for (int iteration = 0; iteration < APP_GJK_MAX_ITERATIONS; ++iteration) {
+        float closest_distance = closest_point.Dot(closest_point);
+        float max_vertex_distance = 0.0f;
+        for (int index = 0; index < size; ++index) {
+            max_vertex_distance = (std::max)(max_vertex_distance, simplex[index].Dot(simplex[index]));
+        }
+        if (closest_distance <= APP_GJK_RELATIVE_TOLERANCE * APP_GJK_RELATIVE_TOLERANCE * max_vertex_distance) {
+            // Origin is on the boundary of the simplex: the hulls touch or the origin lies on a face deep inside
+            contact.is_intersecting = true;
+            if ((penetration_buffers != nullptr) && CompleteTetrahedron(first, second, simplex, size)) {
+                ComputeContactPenetration(first, second, simplex, *penetration_buffers, contact);
+            }
+            return contact;
+        }
+
+        GL::Vec3 support = GetDifferenceSupport(first, second, closest_point * -1.0f);
+        // No point of the difference is closer than the bound, the distance has converged
+        if (closest_distance - closest_point.Dot(support) <= APP_GJK_RELATIVE_TOLERANCE * closest_distance) {
+            break;
+        }
+        // Rounding may bring back a vertex of the simplex, it would only cycle
+        if (std::find_if(simplex, simplex + size, [&support](const GL::Vec3& vertex) {
+            return (vertex.X == support.X) && (vertex.Y == support.Y) && (vertex.Z == support.Z);
+        }) != simplex + size) {
+            break;
+        }
+        GL::Vec3 previous_simplex[4];
+        std::copy(simplex, simplex + size, previous_simplex);
+        int previous_size = size;
+        GL::Vec3 previous_closest_point = closest_point;
+        simplex[size++] = support;
+
+        if (size == 2) {
+            closest_point = ReduceSegment(simplex, size);
+        } else if (size == 3) {
+            closest_point = ReduceTriangle(simplex, size);
+        } else if (!ReduceTetrahedron(simplex, size, closest_point)) {
+            contact.is_intersecting = true;
+            if (penetration_buffers != nullptr) {
+                ComputeContactPenetration(first, second, simplex, *penetration_buffers, contact);
+            }
+            return contact;
+        }
+
+        // Same for a step that doesn't get closer, the previous simplex is kept
+        if (closest_point.Dot(closest_point) >= closest_distance) {
+            std::copy(previous_simplex, previous_simplex + previous_size, simplex);
+            size = previous_size;
+            closest_point = previous_closest_point;
+            break;
+        }
+    }
+
+    contact.distance = closest_point.Length();
+    contact.direction = closest_point * (-1.0f / contact.distance);
+    return contact;
+}
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+// STL
+#include <memory>
+#include <utility>
+#include <vector>
+
+// OpenGL Wrapper
+#include <GL/OOGL.hpp>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <convex_hull/convex_hull_fwd.hpp>
+
+namespace App {
+
+/*
+    Convex hull of the mesh vertices in mesh space, built by quickhull once when the mesh is loaded
+    and shared by all the copies of the mesh. Flat meshes keep all their vertices, support queries are exact anyway
+*/
+class ConvexHull {
+public:
+    ConvexHull(const std::vector<GL::Vertex>& vertices);
+
+    bool IsEmpty() const { return x_.empty(); }
+    size_t GetVerticesCount() const { return x_.size(); }
+    GL::Vec3 GetVertex(const size_t index) const { return GL::Vec3{x_[index], y_[index], z_[index]}; }
+
+    // Hull vertex farthest along the direction
+    GL::Vec3 GetSupport(const GL::Vec3& direction) const;
+
+private:
+    // Returns false if the points don't span a volume
+    bool BuildQuickhull(const std::vector<GL::Vec3>& points);
+    void KeepPoints(const std::vector<GL::Vec3>& points);
+
+    std::vector<float> x_;
+    std::vector<float> y_;
+    std::vector<float> z_;
+};
+
+// Mesh hull placed into the world
+struct ConvexHullInstance {
+    std::shared_ptr<const ConvexHull> hull;
+    GL::Mat4 mesh_to_world;
+};
+
+struct ConvexHullsContact {
+    bool is_intersecting;
+    float distance; // 0 if the hulls intersect
+    float penetration_depth; // 0 if the hulls are separated, only touch or it wasn't requested
+    /*
+        Unit direction from the first hull to the second one (separating direction or penetration normal).
+        Given as the initial direction of the next query of the same pair, it brings GJK down to a few iterations
+    */
+    GL::Vec3 direction;
+};
+
+struct PolytopeFace {
+    int vertices[3];
+    GL::Vec3 normal;
+    float distance;
+};
+
+// Expanding polytope of EPA, kept by the caller so that nothing is allocated once the vectors have grown
+struct PenetrationBuffers {
+    std::vector<GL::Vec3> vertices;
+    std::vector<PolytopeFace> faces;
+    std::vector<std::pair<int, int>> edges;
+};
+
+/*
+    GJK gives the overlap and the distance, EPA continues from its last simplex to the penetration depth
+    only if the buffers are given. Initial direction may be anything, a zero one is replaced by the X axis
+*/
+ConvexHullsContact IntersectConvexHulls(const ConvexHullInstance& first, const ConvexHullInstance& second,
+    const GL::Vec3& initial_direction, PenetrationBuffers* penetration_buffers = nullptr);
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace App {
+
+class ConvexHull;
+
+struct ConvexHullInstance;
+struct ConvexHullsContact;
+
+} // namespace App
\ No newline at end of file
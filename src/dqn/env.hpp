@@ -8,40 +8,56 @@
 
 // LibSmartCar
 #include <helpers/helpers.hpp>
+#include <world/world.hpp>
+#include <car_model/car_model.hpp>
+#include <dqn/types.hpp>
 
 namespace AppNN {
 
 class Environment {
 public:
-    void Step(float delta_time) {
-        auto& context = App::Context::Get();
-        context.car_model->Move(delta_time);
+    Environment(App::World& world)
+    : world(world), prev_position(GL::Vec3(0.0, 0.0, 0.0)) {}
+
+    // Puts the car back to the start and refreshes the state
+    void Reset() {
+        world.ClearCarTransform();
+        world.actions.fill(false);
+        Step(0.0f);
+    }
+
+    // Without rays the state is refreshed by UpdateState after the caller writes the distances into the world
+    void Step(float delta_time, const bool update_rays = true) {
+        world.Step(delta_time, update_rays);
+        if (update_rays) {
+            UpdateState();
+        }
+    }
 
+    void UpdateState() {
         for (int i = 0; i < App::APP_RAY_INTERSECTOR_RAYS_COUNT; ++i) {
-            context.state[i] = isinf(context.distances_from_rays[i]) ? 100.0 : context.distances_from_rays[i];
+            world.state[i] = isinf(world.distances_from_rays[i]) ? 100.0 : world.distances_from_rays[i];
         }
 
-        GL::Vec3 cur_position = context.car_model->GetPosition();
-        context.state[App::APP_RAY_INTERSECTOR_RAYS_COUNT + 0] = cur_position.X;
-        context.state[App::APP_RAY_INTERSECTOR_RAYS_COUNT + 1] = cur_position.Y;
-        context.state[App::APP_RAY_INTERSECTOR_RAYS_COUNT + 2] = cur_position.Z;
+        GL::Vec3 cur_position = world.car_model->GetPosition();
+        world.state[App::APP_RAY_INTERSECTOR_RAYS_COUNT + 0] = cur_position.X;
+        world.state[App::APP_RAY_INTERSECTOR_RAYS_COUNT + 1] = cur_position.Y;
+        world.state[App::APP_RAY_INTERSECTOR_RAYS_COUNT + 2] = cur_position.Z;
 
-        float cur_speed = context.car_model->GetSpeed();
-        context.state[App::APP_RAY_INTERSECTOR_RAYS_COUNT + 3] = cur_speed;
+        float cur_speed = world.car_model->GetSpeed();
+        world.state[App::APP_RAY_INTERSECTOR_RAYS_COUNT + 3] = cur_speed;
     }
 
     Reward GetReward() {
-        auto& context = App::Context::Get();
         Reward ans = -1;
 
         static const GL::Vec3 final_destination = GL::Vec3(56.0, 0.0, 0.0);
-        static GL::Vec3 prev_position = GL::Vec3(0.0, 0.0, 0.0);
-        GL::Vec3 cur_position = context.car_model->GetPosition();
+        GL::Vec3 cur_position = world.car_model->GetPosition();
 
         float prev_distance = (prev_position - final_destination).Length();
         float cur_distance = (cur_position - final_destination).Length();
 
-        float cur_speed = context.car_model->GetSpeed();
+        float cur_speed = world.car_model->GetSpeed();
         if (std::fabs(cur_speed) < 2.0) {
             ans -= 1000;
         }
@@ -67,9 +83,7 @@ public:
     }
 
     bool IsDone() const {
-        auto& context = App::Context::Get();
-
-        GL::Vec3 cur_position = context.car_model->GetPosition();
+        GL::Vec3 cur_position = world.car_model->GetPosition();
         static const GL::Vec3 final_destination = GL::Vec3(56.0, 0.0, 0.0);
 
         float cur_distance = (cur_position - final_destination).Length();
@@ -79,6 +93,10 @@ public:
         }
         return false;
     }
+
+private:
+    App::World& world;
+    GL::Vec3 prev_position;
 };
 
 } // namespace AppNN
\ No newline at end of file
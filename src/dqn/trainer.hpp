@@ -13,6 +13,7 @@
 
 // LibSmartCar
 #include <helpers/helpers.hpp>
+#include <world/world.hpp>
 #include <dqn/net.hpp>
 #include <dqn/env.hpp>
 #include <dqn/replay_buffer.hpp>
@@ -37,9 +38,10 @@ const double GAMMA = 0.99;
 
 class Trainer {
 public:
-    Trainer()
-    : net(Net{App::APP_CAR_STATE_PARAMETERS_COUNT, App::APP_CAR_ACTIONS_COUNT}),
-    optimizer(torch::optim::Adam{net->parameters(), torch::optim::AdamOptions(5e-1).betas(std::make_tuple(0.5, 0.5)).weight_decay(1e-5)}) {
+    Trainer(App::World& world)
+    : world(world), net(Net{App::APP_CAR_STATE_PARAMETERS_COUNT, App::APP_CAR_ACTIONS_COUNT}),
+    optimizer(torch::optim::Adam{net->parameters(), torch::optim::AdamOptions(5e-1).betas(std::make_tuple(0.5, 0.5)).weight_decay(1e-5)}),
+    env(Environment{world}), steps_count(0), zero_speed_steps_count(0) {
         if (torch::cuda::is_available()){
             std::cout << "CUDA available! Running on GPU..." << std::endl;
             device = torch::Device(torch::kCUDA);
@@ -58,8 +60,6 @@ public:
 
         optimizer.zero_grad();
 
-        static int steps_count = 0;
-        static int zero_speed_steps_count = 0;
         static State no_state = State{};
         no_state.fill(0.0);
 
@@ -67,10 +67,10 @@ public:
         double sample = 1.0 * rand() / RAND_MAX;
         double eps_threshold = EPS_END + (EPS_START - EPS_END) * exp(-1.0 * steps_count / EPS_DECAY);
         ++steps_count;
-        if (std::fabs(context.car_model->GetSpeed() < 0.01)) {
+        if (std::fabs(world.car_model->GetSpeed() < 0.01)) {
             ++zero_speed_steps_count;
             if (zero_speed_steps_count >= 20) {
-                context.ClearCarTransform();
+                world.ClearCarTransform();
 
                 steps_count = 0;
                 zero_speed_steps_count = 0;
@@ -79,8 +79,8 @@ public:
             zero_speed_steps_count = 0;
         }
 
-        context.actions.fill(false);
-        State state = context.state;
+        world.actions.fill(false);
+        State state = world.state;
         torch::Tensor qvls;
         Action action;
 
@@ -103,16 +103,22 @@ public:
                 }
             }
             action = best_action_index;
-            context.actions[best_action_index] = true;
+            world.actions[best_action_index] = true;
         } else {
-            int random_action_index = std::mt19937{std::random_device{}()}() % context.actions.size();
+            int random_action_index = std::mt19937{std::random_device{}()}() % world.actions.size();
             action = random_action_index;
-            context.actions[random_action_index] = true;
+            world.actions[random_action_index] = true;
+        }
+
+        // While learning, the car is driven by the user and NN is trained to repeat user's actions
+        if (context.keyboard_mode.value() == App::KeyboardMode::NN_LEARNING) {
+            world.user_selected_actions = App::GetKeyboardActions(context.keyboard_status.value());
+            world.actions = world.user_selected_actions;
         }
 
         // Environment step
         env.Step(delta_time);
-        State new_state = context.state;
+        State new_state = world.state;
         Reward reward = env.GetReward();
         if (env.IsDone()) {
             std::cout << "DONE!" << std::endl;
@@ -121,11 +127,11 @@ public:
         }
 
 
-        if (context.keyboard_mode.value() == App::KeyboardMode::NN_LEARNING && ((context.user_selected_actions[0] || context.user_selected_actions[1] || context.user_selected_actions[2] || context.user_selected_actions[3]))) {
+        if (context.keyboard_mode.value() == App::KeyboardMode::NN_LEARNING && ((world.user_selected_actions[0] || world.user_selected_actions[1] || world.user_selected_actions[2] || world.user_selected_actions[3]))) {
             Qvalues new_qvalues;
             new_qvalues.fill(0.0);
-            for (int i = 0; i < context.user_selected_actions.size(); ++i) {
-                if (context.user_selected_actions[i]) {
+            for (int i = 0; i < world.user_selected_actions.size(); ++i) {
+                if (world.user_selected_actions[i]) {
                     new_qvalues[i] = 150.0;
                 }
             }
@@ -276,12 +282,17 @@ public:
     }
     
 private:
+    App::World& world;
+
     torch::Device device = torch::Device(torch::kCPU);
     Net net{nullptr};
     torch::optim::Adam optimizer;
 
     ReplayBuffer buffer{100'000};
-    Environment env{};
+    Environment env;
+
+    int steps_count;
+    int zero_speed_steps_count;
 };
 
 
@@ -22,7 +22,7 @@ constexpr int APP_NN_TRANSITION_REWARD_INDEX = 3;
 constexpr int APP_NN_BATCH_SIZE = 64;
 
 
-std::array<float, APP_NN_BATCH_SIZE * App::APP_CAR_STATE_PARAMETERS_COUNT> StatesBatchToRaw(std::array<State, APP_NN_BATCH_SIZE> states_batch) {
+inline std::array<float, APP_NN_BATCH_SIZE * App::APP_CAR_STATE_PARAMETERS_COUNT> StatesBatchToRaw(std::array<State, APP_NN_BATCH_SIZE> states_batch) {
     std::array<float, APP_NN_BATCH_SIZE * App::APP_CAR_STATE_PARAMETERS_COUNT> ans;
     for (int i = 0; i < states_batch.size(); ++i) {
         for (int j = 0; j < APP_NN_BATCH_SIZE; ++j) {
@@ -0,0 +1,362 @@
+// WARNING: winsock2.h must be included before windows.h (which comes with the window headers)
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "env_server.hpp"
+
+// STL
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+namespace AppNN {
+
+// Extern variables
+/* empty */
+
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+constexpr std::intptr_t APP_ENV_SERVER_INVALID_SOCKET = static_cast<std::intptr_t>(INVALID_SOCKET);
+
+static void CloseNativeSocket(std::intptr_t socket) {
+    closesocket(static_cast<NativeSocket>(socket));
+}
+constexpr int APP_ENV_SERVER_SEND_FLAGS = 0;
+#else
+using NativeSocket = int;
+constexpr std::intptr_t APP_ENV_SERVER_INVALID_SOCKET = -1;
+// Disconnected client must surface as an error, not as SIGPIPE killing the server
+constexpr int APP_ENV_SERVER_SEND_FLAGS = MSG_NOSIGNAL;
+
+static void CloseNativeSocket(std::intptr_t socket) {
+    close(static_cast<NativeSocket>(socket));
+}
+#endif
+
+SocketLibrary::SocketLibrary() {
+#ifdef _WIN32
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        throw std::runtime_error("SocketLibrary: WSAStartup failed");
+    }
+#endif
+}
+
+SocketLibrary::~SocketLibrary() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+SocketHandle::SocketHandle()
+    : socket_(APP_ENV_SERVER_INVALID_SOCKET) {}
+
+SocketHandle::SocketHandle(const std::intptr_t socket)
+    : socket_(socket) {}
+
+SocketHandle::~SocketHandle() {
+    Reset(APP_ENV_SERVER_INVALID_SOCKET);
+}
+
+bool SocketHandle::IsValid() const {
+    return socket_ != APP_ENV_SERVER_INVALID_SOCKET;
+}
+
+void SocketHandle::Reset(const std::intptr_t socket) {
+    if (IsValid()) {
+        CloseNativeSocket(socket_);
+    }
+    socket_ = socket;
+}
+
+SharedMemory::SharedMemory(const std::string& name, const size_t size)
+    : name_(name), size_(size), data_(nullptr), handle_(0) {
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(static_cast<std::uint64_t>(size_) >> 32), static_cast<DWORD>(size_ & 0xFFFFFFFF), name_.c_str());
+    if (mapping == nullptr) {
+        throw std::runtime_error("SharedMemory: can't create file mapping: " + name_);
+    }
+    data_ = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size_);
+    if (data_ == nullptr) {
+        CloseHandle(mapping);
+        throw std::runtime_error("SharedMemory: can't map view of file: " + name_);
+    }
+    handle_ = reinterpret_cast<std::intptr_t>(mapping);
+#else
+    // POSIX requires the name to start with a slash
+    if (name_.empty() || name_[0] != '/') {
+        name_ = '/' + name_;
+    }
+    int descriptor = shm_open(name_.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+    if (descriptor < 0) {
+        throw std::runtime_error("SharedMemory: can't open shared memory: " + name_);
+    }
+    if (ftruncate(descriptor, static_cast<off_t>(size_)) != 0) {
+        close(descriptor);
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("SharedMemory: can't resize shared memory: " + name_);
+    }
+    data_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        close(descriptor);
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("SharedMemory: can't map shared memory: " + name_);
+    }
+    handle_ = descriptor;
+#endif
+    std::memset(data_, 0, size_);
+}
+
+SharedMemory::~SharedMemory() {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(reinterpret_cast<HANDLE>(handle_));
+#else
+    munmap(data_, size_);
+    close(static_cast<int>(handle_));
+    shm_unlink(name_.c_str());
+#endif
+}
+
+EnvServer::EnvServer(const std::string& socket_path, const std::string& shared_memory_name, std::vector<std::unique_ptr<App::World>> worlds)
+    : socket_path_(socket_path), environments_count_(static_cast<int>(worlds.size())),
+    shared_memory_(shared_memory_name, ComputeSharedMemorySize(static_cast<int>(worlds.size()))),
+    header_(static_cast<SharedBatchHeader*>(shared_memory_.GetData())),
+    socket_library_(), listen_socket_(), client_socket_(),
+    worlds_(std::move(worlds)), environments_({}), rays_batched_(false) {
+    if (environments_count_ <= 0) {
+        throw std::runtime_error("EnvServer: environments count must be positive");
+    }
+    InitHeader();
+
+    // Batch needs the same obstacles for every car
+    auto first_registry = worlds_[0]->car_model->GetRayIntersector()->GetObstacleRegistry();
+    rays_batched_ = (environments_count_ > 1) && std::all_of(worlds_.begin(), worlds_.end(), [&first_registry](const std::unique_ptr<App::World>& world) {
+        return world->car_model->GetRayIntersector()->GetObstacleRegistry() == first_registry;
+    });
+    car_model_matrices_.reserve(environments_count_);
+
+    // Every environment starts from the initial car position
+    environments_.reserve(environments_count_);
+    for (int environment_index = 0; environment_index < environments_count_; ++environment_index) {
+        environments_.emplace_back(*worlds_[environment_index]);
+        environments_[environment_index].Reset();
+        WriteResults(environment_index, 0, false);
+    }
+
+    listen_socket_.Reset(static_cast<std::intptr_t>(socket(AF_UNIX, SOCK_STREAM, 0)));
+    if (!listen_socket_.IsValid()) {
+        throw std::runtime_error("EnvServer: can't create socket");
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path_.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("EnvServer: socket path is too long: " + socket_path_);
+    }
+    std::strncpy(address.sun_path, socket_path_.c_str(), sizeof(address.sun_path) - 1);
+
+    // Socket file may be left from the previous run
+    std::error_code error_code;
+    std::filesystem::remove(socket_path_, error_code);
+
+    if (bind(static_cast<NativeSocket>(listen_socket_.Get()), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        throw std::runtime_error("EnvServer: can't bind socket: " + socket_path_);
+    }
+    if (listen(static_cast<NativeSocket>(listen_socket_.Get()), 1) != 0) {
+        std::filesystem::remove(socket_path_, error_code);
+        throw std::runtime_error("EnvServer: can't listen on socket: " + socket_path_);
+    }
+}
+
+EnvServer::EnvServer(const App::Config::ServerConfig& config, std::vector<std::unique_ptr<App::World>> worlds)
+    : EnvServer(config.socket_path, config.shared_memory_name, std::move(worlds)) {}
+
+EnvServer::~EnvServer() {
+    // Sockets and the socket library are released by their own destructors
+    std::error_code error_code;
+    std::filesystem::remove(socket_path_, error_code);
+}
+
+void EnvServer::Run() {
+    std::cout << "Environment server is waiting for a client on " << socket_path_ << std::endl;
+    client_socket_.Reset(static_cast<std::intptr_t>(accept(static_cast<NativeSocket>(listen_socket_.Get()), nullptr, nullptr)));
+    if (!client_socket_.IsValid()) {
+        throw std::runtime_error("EnvServer: can't accept client");
+    }
+    std::cout << "Environment server: client connected" << std::endl;
+
+    ControlMessage message{};
+    while (ReceiveMessage(message)) {
+        ControlResponse response{0, static_cast<std::uint32_t>(environments_count_)};
+
+        if (message.type == ControlMessageType::RESET) {
+            response.status = Reset(message.environment_index) ? 0 : 1;
+        } else if (message.type == ControlMessageType::STEP) {
+            response.status = Step(message.delta_time) ? 0 : 1;
+        } else if (message.type == ControlMessageType::CLOSE) {
+            SendResponse(response);
+            break;
+        } else {
+            response.status = 1;
+        }
+        SendResponse(response);
+    }
+
+    client_socket_.Reset(APP_ENV_SERVER_INVALID_SOCKET);
+    std::cout << "Environment server: client disconnected" << std::endl;
+}
+
+size_t EnvServer::AlignOffset(const size_t offset) {
+    return (offset + App::APP_ENV_SERVER_SHARED_MEMORY_ALIGNMENT - 1) / App::APP_ENV_SERVER_SHARED_MEMORY_ALIGNMENT * App::APP_ENV_SERVER_SHARED_MEMORY_ALIGNMENT;
+}
+
+size_t EnvServer::ComputeSharedMemorySize(const int environments_count) {
+    size_t offset = AlignOffset(sizeof(SharedBatchHeader));
+    offset = AlignOffset(offset + environments_count * App::APP_CAR_STATE_PARAMETERS_COUNT * sizeof(float));
+    offset = AlignOffset(offset + environments_count * App::APP_CAR_ACTIONS_COUNT * sizeof(std::uint8_t));
+    offset = AlignOffset(offset + environments_count * sizeof(float));
+    offset = AlignOffset(offset + environments_count * sizeof(std::uint8_t));
+    return offset;
+}
+
+void EnvServer::InitHeader() {
+    header_->magic = App::APP_ENV_SERVER_SHARED_MEMORY_MAGIC;
+    header_->version = App::APP_ENV_SERVER_SHARED_MEMORY_VERSION;
+    header_->environments_count = environments_count_;
+    header_->observations_count = App::APP_CAR_STATE_PARAMETERS_COUNT;
+    header_->actions_count = App::APP_CAR_ACTIONS_COUNT;
+
+    size_t offset = AlignOffset(sizeof(SharedBatchHeader));
+    header_->observations_offset = static_cast<std::uint32_t>(offset);
+    offset = AlignOffset(offset + environments_count_ * App::APP_CAR_STATE_PARAMETERS_COUNT * sizeof(float));
+    header_->actions_offset = static_cast<std::uint32_t>(offset);
+    offset = AlignOffset(offset + environments_count_ * App::APP_CAR_ACTIONS_COUNT * sizeof(std::uint8_t));
+    header_->rewards_offset = static_cast<std::uint32_t>(offset);
+    offset = AlignOffset(offset + environments_count_ * sizeof(float));
+    header_->dones_offset = static_cast<std::uint32_t>(offset);
+    header_->total_size = static_cast<std::uint32_t>(shared_memory_.GetSize());
+}
+
+bool EnvServer::Reset(const std::uint32_t environment_index) {
+    if ((environment_index != App::APP_ENV_SERVER_ALL_ENVIRONMENTS) && (environment_index >= static_cast<std::uint32_t>(environments_count_))) {
+        return false;
+    }
+
+    for (int index = 0; index < environments_count_; ++index) {
+        if ((environment_index != App::APP_ENV_SERVER_ALL_ENVIRONMENTS) && (environment_index != static_cast<std::uint32_t>(index))) {
+            continue;
+        }
+        environments_[index].Reset();
+        WriteResults(index, 0, false);
+    }
+    return true;
+}
+
+bool EnvServer::Step(const float delta_time) {
+    if (!std::isfinite(delta_time) || (delta_time < 0.0f)) {
+        return false;
+    }
+
+    for (int environment_index = 0; environment_index < environments_count_; ++environment_index) {
+        auto& world = *worlds_[environment_index];
+
+        auto actions = GetActions(environment_index);
+        for (int action_index = 0; action_index < App::APP_CAR_ACTIONS_COUNT; ++action_index) {
+            world.actions[action_index] = (actions[action_index] != 0);
+        }
+
+        environments_[environment_index].Step(delta_time, !rays_batched_);
+    }
+
+    if (rays_batched_) {
+        IntersectRaysBatch();
+    }
+    for (int environment_index = 0; environment_index < environments_count_; ++environment_index) {
+        auto& environment = environments_[environment_index];
+        WriteResults(environment_index, environment.GetReward(), environment.IsDone());
+    }
+    return true;
+}
+
+void EnvServer::IntersectRaysBatch() {
+    car_model_matrices_.clear();
+    for (auto& world : worlds_) {
+        car_model_matrices_.push_back(world->car_model->GetModelMatrix());
+    }
+    worlds_[0]->car_model->GetRayIntersector()->IntersectBatch(car_model_matrices_, batch_distances_);
+
+    for (int environment_index = 0; environment_index < environments_count_; ++environment_index) {
+        auto& world = *worlds_[environment_index];
+        auto car_distances = batch_distances_.begin() + environment_index * App::APP_RAY_INTERSECTOR_RAYS_COUNT;
+        std::copy(car_distances, car_distances + App::APP_RAY_INTERSECTOR_RAYS_COUNT, world.distances_from_rays.begin());
+        environments_[environment_index].UpdateState();
+    }
+}
+
+void EnvServer::WriteResults(const int environment_index, const Reward reward, const bool done) {
+    auto& world = *worlds_[environment_index];
+    std::copy(world.state.begin(), world.state.end(), GetObservations(environment_index));
+    *GetRewards(environment_index) = static_cast<float>(reward);
+    *GetDones(environment_index) = done ? 1 : 0;
+}
+
+bool EnvServer::ReceiveMessage(ControlMessage& message) {
+    auto buffer = reinterpret_cast<char*>(&message);
+    size_t received = 0;
+    while (received < sizeof(ControlMessage)) {
+        auto result = recv(static_cast<NativeSocket>(client_socket_.Get()), buffer + received, static_cast<int>(sizeof(ControlMessage) - received), 0);
+        if (result <= 0) {
+            return false;
+        }
+        received += result;
+    }
+    return true;
+}
+
+void EnvServer::SendResponse(const ControlResponse& response) {
+    auto buffer = reinterpret_cast<const char*>(&response);
+    size_t sent = 0;
+    while (sent < sizeof(ControlResponse)) {
+        auto result = send(static_cast<NativeSocket>(client_socket_.Get()), buffer + sent, static_cast<int>(sizeof(ControlResponse) - sent), APP_ENV_SERVER_SEND_FLAGS);
+        if (result <= 0) {
+            throw std::runtime_error("EnvServer: can't send response");
+        }
+        sent += result;
+    }
+}
+
+float* EnvServer::GetObservations(const int environment_index) const {
+    auto base = static_cast<char*>(shared_memory_.GetData()) + header_->observations_offset;
+    return reinterpret_cast<float*>(base) + environment_index * App::APP_CAR_STATE_PARAMETERS_COUNT;
+}
+
+std::uint8_t* EnvServer::GetActions(const int environment_index) const {
+    auto base = static_cast<char*>(shared_memory_.GetData()) + header_->actions_offset;
+    return reinterpret_cast<std::uint8_t*>(base) + environment_index * App::APP_CAR_ACTIONS_COUNT;
+}
+
+float* EnvServer::GetRewards(const int environment_index) const {
+    auto base = static_cast<char*>(shared_memory_.GetData()) + header_->rewards_offset;
+    return reinterpret_cast<float*>(base) + environment_index;
+}
+
+std::uint8_t* EnvServer::GetDones(const int environment_index) const {
+    auto base = static_cast<char*>(shared_memory_.GetData()) + header_->dones_offset;
+    return reinterpret_cast<std::uint8_t*>(base) + environment_index;
+}
+
+} // namespace AppNN
\ No newline at end of file
@@ -0,0 +1,179 @@
+#pragma once
+
+// STL
+#define NOMINMAX
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <env_server/env_server_fwd.hpp>
+
+// LibSmartCar
+#include <helpers/helpers.hpp>
+#include <config/config_handler.hpp>
+#include <world/world.hpp>
+#include <dqn/env.hpp>
+
+namespace AppNN {
+
+/*
+    Shared memory layout (all offsets are in bytes from the beginning of the block):
+        SharedBatchHeader
+        float         observations[environments_count][observations_count]
+        std::uint8_t  actions[environments_count][actions_count]      <- written by the client
+        float         rewards[environments_count]
+        std::uint8_t  dones[environments_count]
+    Every array starts at an offset aligned to APP_ENV_SERVER_SHARED_MEMORY_ALIGNMENT
+*/
+struct SharedBatchHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t environments_count;
+    std::uint32_t observations_count;
+    std::uint32_t actions_count;
+    std::uint32_t observations_offset;
+    std::uint32_t actions_offset;
+    std::uint32_t rewards_offset;
+    std::uint32_t dones_offset;
+    std::uint32_t total_size;
+};
+
+enum class ControlMessageType: std::uint32_t {
+    RESET = 0,
+    STEP,
+    CLOSE
+};
+
+// Control messages are sent over the socket, the batch data itself lives in shared memory
+struct ControlMessage {
+    ControlMessageType type;
+    std::uint32_t environment_index; // RESET only, APP_ENV_SERVER_ALL_ENVIRONMENTS resets the whole batch
+    float delta_time; // STEP only
+};
+
+struct ControlResponse {
+    std::uint32_t status; // 0 on success
+    std::uint32_t environments_count;
+};
+
+/*
+    Named block of memory shared with another process
+    (POSIX shm_open on Linux, named file mapping on Windows)
+*/
+class SharedMemory {
+public:
+    SharedMemory(const std::string& name, const size_t size);
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    void* GetData() const { return data_; }
+    size_t GetSize() const { return size_; }
+
+private:
+    std::string name_;
+    size_t size_;
+    void* data_;
+    std::intptr_t handle_;
+};
+
+/*
+    Owns the platform socket library (WSAStartup / WSACleanup on Windows, nothing on Linux),
+    must outlive every socket created by the owner
+*/
+class SocketLibrary {
+public:
+    SocketLibrary();
+    ~SocketLibrary();
+
+    SocketLibrary(const SocketLibrary&) = delete;
+    SocketLibrary& operator=(const SocketLibrary&) = delete;
+};
+
+// Closes the native socket on destruction, so a throwing constructor doesn't leak it
+class SocketHandle {
+public:
+    SocketHandle();
+    explicit SocketHandle(const std::intptr_t socket);
+    ~SocketHandle();
+
+    SocketHandle(const SocketHandle&) = delete;
+    SocketHandle& operator=(const SocketHandle&) = delete;
+
+    bool IsValid() const;
+    std::intptr_t Get() const { return socket_; }
+
+    // Closes the previous socket if any
+    void Reset(const std::intptr_t socket);
+
+private:
+    std::intptr_t socket_;
+};
+
+/*
+    Gym-style server: the client writes actions for the whole batch into
+    shared memory and sends a single STEP message over the Unix domain socket,
+    the server steps all environments and answers when observations, rewards
+    and dones are ready. When all the cars share one obstacle registry their rays
+    are traced by a single RayIntersector::IntersectBatch call per step
+*/
+class EnvServer {
+public:
+    // Every world is stepped as a separate environment of the batch
+    EnvServer(const std::string& socket_path, const std::string& shared_memory_name, std::vector<std::unique_ptr<App::World>> worlds);
+    EnvServer(const App::Config::ServerConfig& config, std::vector<std::unique_ptr<App::World>> worlds);
+    ~EnvServer();
+
+    EnvServer(const EnvServer&) = delete;
+    EnvServer& operator=(const EnvServer&) = delete;
+
+    // Serves one client until it sends CLOSE or disconnects
+    void Run();
+
+private:
+    static size_t AlignOffset(const size_t offset);
+    static size_t ComputeSharedMemorySize(const int environments_count);
+
+    void InitHeader();
+    // Return false for an unknown environment index or an invalid time step
+    bool Reset(const std::uint32_t environment_index);
+    bool Step(const float delta_time);
+    void IntersectRaysBatch();
+
+    void WriteResults(const int environment_index, const Reward reward, const bool done);
+
+    bool ReceiveMessage(ControlMessage& message);
+    void SendResponse(const ControlResponse& response);
+
+    float* GetObservations(const int environment_index) const;
+    std::uint8_t* GetActions(const int environment_index) const;
+    float* GetRewards(const int environment_index) const;
+    std::uint8_t* GetDones(const int environment_index) const;
+
+    const std::string socket_path_;
+    const int environments_count_;
+
+    SharedMemory shared_memory_;
+    SharedBatchHeader* header_;
+
+    // WARNING: must be declared before the sockets to be destroyed after them
+    SocketLibrary socket_library_;
+    SocketHandle listen_socket_;
+    SocketHandle client_socket_;
+
+    std::vector<std::unique_ptr<App::World>> worlds_;
+    std::vector<Environment> environments_;
+
+    bool rays_batched_;
+    std::vector<GL::Mat4> car_model_matrices_;
+    std::vector<float> batch_distances_;
+};
+
+} // namespace AppNN
\ No newline at end of file
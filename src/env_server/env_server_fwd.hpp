@@ -0,0 +1,12 @@
+#pragma once
+
+namespace AppNN {
+
+struct SharedBatchHeader;
+struct ControlMessage;
+struct ControlResponse;
+
+class SharedMemory;
+class EnvServer;
+
+} // namespace AppNN
\ No newline at end of file
@@ -41,7 +41,7 @@ void Gui::Prepare() const {
     ImGui::NewFrame();
 }
 
-void Gui::Draw() {
+void Gui::Draw(World& world) {
     auto& context = App::Context::Get();
 
     ///// LEFT MENU /////
@@ -96,7 +96,10 @@ void Gui::Draw() {
     //ImGui::Begin("Parameters");
 
     if (ImGui::Button("Clear car transform")) {
-        context.ClearCarTransform();
+        world.ClearCarTransform();
+
+        // Update camera target and position
+        context.camera->reached_final_position_ = false;
     }
     ImGui::SameLine();
     ImGui::Checkbox("Demo Window", &show_imgui_demo_window);
@@ -107,7 +110,7 @@ void Gui::Draw() {
 
     // Car model
     ImGui::PushID("car_model");
-    if (ImGui::TreeNode(context.car_model->name_.c_str())) {
+    if (ImGui::TreeNode(world.car_model->name_.c_str())) {
 
         // WARNING: be careful with ImGui ID system: without PushID
         // both "All BBoxes" enable and disable buttons and
@@ -118,13 +121,13 @@ void Gui::Draw() {
         ImGui::Text("Wheels BBoxes");
         ImGui::SameLine();
         if (ImGui::SmallButton("Enable")) {
-            context.car_model->SetDrawWheelsBBoxes(true);
+            world.car_model->SetDrawWheelsBBoxes(true);
         }
         ImGui::SameLine();
         if (ImGui::SmallButton("Disable")) {
-            context.car_model->SetDrawWheelsBBoxes(false);
+            world.car_model->SetDrawWheelsBBoxes(false);
         }
-        ModelMeshBBoxSelector(context.car_model);
+        ModelMeshBBoxSelector(world.car_model);
 
         ImGui::PopID(); // wheels
     }
@@ -142,24 +145,28 @@ void Gui::Draw() {
 
     ImGui::SeparatorText("Obstacles");
 
-    for (int model_idx = 0; model_idx < context.obstacles.size(); ++model_idx) {
+    for (int model_idx = 0; model_idx < world.obstacles.size(); ++model_idx) {
         ImGui::PushID(model_idx);
-        if (ImGui::TreeNode(context.obstacles[model_idx]->name_.c_str())) {
-            ModelMeshBBoxSelector(context.obstacles[model_idx]);
+        if (ImGui::TreeNode(world.obstacles[model_idx]->name_.c_str())) {
+            ModelMeshBBoxSelector(world.obstacles[model_idx]);
         }
         ImGui::PopID();
     }
 
     // Car state
     ImGui::SeparatorText("Car state");
-    auto car_position = context.car_model->GetPosition();
+    auto car_position = world.car_model->GetPosition();
     ImGui::Text("Car position: x = %.3f, y = %.3f, z = %.3f", car_position.X, car_position.Y, car_position.Z);
-    ImGui::Text("Car speed = %.3f", context.car_model->GetSpeed());
-    ImGui::Text("Actions: %.1f, %.1f, %.1f, %.1f", context.actions[0] ? 1.0 : 0.0, context.actions[1] ? 1.0 : 0.0, context.actions[2] ? 1.0 : 0.0, context.actions[3] ? 1.0 : 0.0);
+    ImGui::Text("Car yaw = %.3f rad", world.car_model->GetYaw());
+    ImGui::Text("Car speed = %.3f", world.car_model->GetSpeed());
+    ImGui::Text("Actions: %.1f, %.1f, %.1f, %.1f", world.actions[0] ? 1.0 : 0.0, world.actions[1] ? 1.0 : 0.0, world.actions[2] ? 1.0 : 0.0, world.actions[3] ? 1.0 : 0.0);
 
     // DISTANCES FROM RAYS
     ImGui::SeparatorText("Distances from rays");
-    ImGui::PlotHistogram("", context.distances_from_rays.data(), APP_RAY_INTERSECTOR_RAYS_COUNT, 0, NULL, 0.0f, 30.0f, ImVec2(0, 80.0f));
+    ImGui::PlotHistogram("", world.distances_from_rays.data(), APP_RAY_INTERSECTOR_RAYS_COUNT, 0, NULL, 0.0f, 30.0f, ImVec2(0, 80.0f));
+    if (std::isfinite(world.nearest_obstacle_distance)) {
+        ImGui::Text("Nearest obstacle = %.3f", world.nearest_obstacle_distance);
+    }
 
     // CAMERA PARAMETERS
     ImGui::SeparatorText("Camera parameters");
@@ -16,6 +16,7 @@
 #include <car_model/car_model.hpp>
 #include <model/model.hpp>
 #include <helpers/helpers.hpp>
+#include <world/world.hpp>
 #include <config/config_handler.hpp>
 
 namespace App {
@@ -27,8 +28,8 @@ public:
     void Cleanup() const;
     void Prepare() const;
 
-    // This function changes context variables, so it is not const
-    void Draw();
+    // This function changes context and world variables, so it is not const
+    void Draw(World& world);
 
 private:
     void ModelMeshBBoxSelector(std::shared_ptr<App::Model> model) const;
@@ -1,7 +1,6 @@
 #include "helpers.hpp"
 
 // Incomplete type resolve
-#include <car_model/car_model.hpp>
 #include <skybox/skybox.hpp>
 
 namespace App {
@@ -19,24 +18,268 @@ Context& Context::Get() {
     return instance;
 }
 
-void Context::ClearCarTransform() {
-    // Update car movement transform
-    car_model->precomputed_movement_transform_ = Transform{};
-    car_model->UpdateMovementTransform();
-    car_model->accelerator_.Stop();
-    
-    // Update camera target and position
-    camera->reached_final_position_ = false;
-}
-
 Context::Context()
-    : gl(std::nullopt), shader_handler(std::nullopt), camera(std::nullopt), projection_matrix(std::nullopt),
-    keyboard_mode(std::nullopt), keyboard_status(std::nullopt), env({}), obstacles({}) {}
+    : gl(std::nullopt), shader_handler(std::nullopt), compute_tile_sizes(std::nullopt), camera(std::nullopt), projection_matrix(std::nullopt),
+    keyboard_mode(std::nullopt), keyboard_status(std::nullopt), env({}) {}
 
 GL::Vec3 GetTranslation(const GL::Mat4& matrix) {
     return GL::Vec3{matrix.m[12], matrix.m[13], matrix.m[14]};
 }
 
+GL::Mat4 GetAffineInverse(const GL::Mat4& matrix) {
+    // Column-major: element (row, column) is m[4 * column + row]
+    auto a = [&matrix](const int row, const int column) {
+        return matrix.m[4 * column + row];
+    };
+
+    // Inverse of the upper 3x3 part by cofactors
+    float cofactors[3][3] = {
+        {a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1), a(1, 2) * a(2, 0) - a(1, 0) * a(2, 2), a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0)},
+        {a(0, 2) * a(2, 1) - a(0, 1) * a(2, 2), a(0, 0) * a(2, 2) - a(0, 2) * a(2, 0), a(0, 1) * a(2, 0) - a(0, 0) * a(2, 1)},
+        {a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1), a(0, 2) * a(1, 0) - a(0, 0) * a(1, 2), a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0)}
+    };
+    float determinant = a(0, 0) * cofactors[0][0] + a(0, 1) * cofactors[0][1] + a(0, 2) * cofactors[0][2];
+    if (determinant == 0.0f) {
+        throw std::runtime_error("GetAffineInverse: matrix is degenerate");
+    }
+    float inverse_determinant = 1.0f / determinant;
+
+    GL::Mat4 result;
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            // Inverse is the transposed cofactors matrix divided by the determinant
+            result.m[4 * column + row] = cofactors[column][row] * inverse_determinant;
+        }
+        result.m[4 * 3 + row] = 0.0f;
+        result.m[4 * row + 3] = 0.0f;
+    }
+    for (int row = 0; row < 3; ++row) {
+        result.m[12 + row] = -(result.m[row] * matrix.m[12] + result.m[4 + row] * matrix.m[13] + result.m[8 + row] * matrix.m[14]);
+    }
+    result.m[15] = 1.0f;
+    return result;
+}
+
+void GetWorldBounds(const MemoryAlignedBBox& bbox, GL::Vec3& min_point, GL::Vec3& max_point) {
+    GL::Mat4 mesh_to_world = bbox.model * bbox.mesh_to_model;
+    for (int corner_index = 0; corner_index < 8; ++corner_index) {
+        GL::Vec3 corner{
+            (corner_index & 1) ? bbox.max_point.X : bbox.min_point.X,
+            (corner_index & 2) ? bbox.max_point.Y : bbox.min_point.Y,
+            (corner_index & 4) ? bbox.max_point.Z : bbox.min_point.Z
+        };
+        GL::Vec3 world_corner = mesh_to_world * corner;
+        if (corner_index == 0) {
+            min_point = world_corner;
+            max_point = world_corner;
+            continue;
+        }
+        min_point = GL::Vec3{(std::min)(min_point.X, world_corner.X), (std::min)(min_point.Y, world_corner.Y), (std::min)(min_point.Z, world_corner.Z)};
+        max_point = GL::Vec3{(std::max)(max_point.X, world_corner.X), (std::max)(max_point.Y, world_corner.Y), (std::max)(max_point.Z, world_corner.Z)};
+    }
+}
+
+std::string AddShaderDefine(const std::string& source, const std::string& name, const int value) {
+    const std::string define = "#define " + name + " " + std::to_string(value) + "\n";
+
+    size_t version_position = source.find("#version");
+    if (version_position == std::string::npos) {
+        return define + source;
+    }
+    size_t line_end = source.find('\n', version_position);
+    if (line_end == std::string::npos) {
+        return source + "\n" + define;
+    }
+    return source.substr(0, line_end + 1) + define + source.substr(line_end + 1);
+}
+
+int GetMaxComputeTileSize(const int requested_tile_size) {
+    GLint max_size_x = 0;
+    GLint max_invocations = 0;
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 0, &max_size_x);
+    glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &max_invocations);
+
+    int tile_size = (std::min)({requested_tile_size, static_cast<int>(max_size_x), static_cast<int>(max_invocations)});
+    if (tile_size <= 0) {
+        throw std::runtime_error("GetMaxComputeTileSize: compute shaders are not supported");
+    }
+    return tile_size;
+}
+
+int GetComputeTileSize(const GL::Program& program) {
+    GLint work_group_size[3] = {};
+    glGetProgramiv(program, GL_COMPUTE_WORK_GROUP_SIZE, work_group_size);
+    return work_group_size[0];
+}
+
+int GetComputeTileSize(const std::string& shader_name) {
+    return Context::Get().compute_tile_sizes.value().at(shader_name);
+}
+
+GLuint GetComputeTilesCount(const size_t items_count, const int tile_size) {
+    return static_cast<GLuint>((items_count + tile_size - 1) / tile_size);
+}
+
+/*
+    Threads of ParallelFor, started on the first call and joined at exit.
+    The calling thread takes ranges too, so a job finishes even if the workers are still asleep
+*/
+class WorkerPool {
+public:
+    static WorkerPool& Get() {
+        static WorkerPool instance;
+        return instance;
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t GetThreadsCount() const { return workers_.size() + 1; }
+
+    // Calls function for every range index, rethrows the first exception after all the ranges are done
+    void Run(const size_t ranges_count, const std::function<void(size_t)>& function) {
+        // Nested calls and calls from several threads at once are not parallelized
+        std::unique_lock<std::mutex> run_lock(run_mutex_, std::try_to_lock);
+        if (is_worker_thread_ || !run_lock.owns_lock()) {
+            for (size_t range_index = 0; range_index < ranges_count; ++range_index) {
+                function(range_index);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &function;
+            ranges_count_ = ranges_count;
+            next_range_ = 0;
+            exception_ = nullptr;
+            ++job_id_;
+        }
+        work_condition_.notify_all();
+
+        RunRanges(function, ranges_count);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_condition_.wait(lock, [this] { return busy_workers_ == 0; });
+        job_ = nullptr;
+        ranges_count_ = 0;
+        if (exception_) {
+            std::exception_ptr exception = exception_;
+            exception_ = nullptr;
+            std::rethrow_exception(exception);
+        }
+    }
+
+private:
+    WorkerPool() {
+        size_t workers_count = static_cast<size_t>((std::max)(std::thread::hardware_concurrency(), 1u)) - 1;
+        workers_.reserve(workers_count);
+        for (size_t worker_index = 0; worker_index < workers_count; ++worker_index) {
+            workers_.emplace_back(&WorkerPool::WorkerLoop, this);
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        work_condition_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void WorkerLoop() {
+        is_worker_thread_ = true;
+        size_t seen_job_id = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            work_condition_.wait(lock, [this, seen_job_id] { return stop_ || (job_id_ != seen_job_id); });
+            if (stop_) {
+                return;
+            }
+            seen_job_id = job_id_;
+
+            // Job is copied under the lock, the caller doesn't return while the worker is busy
+            const std::function<void(size_t)>* job = job_;
+            const size_t ranges_count = ranges_count_;
+            ++busy_workers_;
+            lock.unlock();
+
+            if (job) {
+                RunRanges(*job, ranges_count);
+            }
+
+            lock.lock();
+            if (--busy_workers_ == 0) {
+                done_condition_.notify_all();
+            }
+        }
+    }
+
+    void RunRanges(const std::function<void(size_t)>& function, const size_t ranges_count) {
+        while (true) {
+            size_t range_index = next_range_.fetch_add(1);
+            if (range_index >= ranges_count) {
+                return;
+            }
+            try {
+                function(range_index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!exception_) {
+                    exception_ = std::current_exception();
+                }
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+
+    std::mutex run_mutex_; // one job at a time
+    std::mutex mutex_;
+    std::condition_variable work_condition_;
+    std::condition_variable done_condition_;
+
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t job_id_ = 0;
+    size_t ranges_count_ = 0;
+    std::atomic<size_t> next_range_{0};
+    size_t busy_workers_ = 0;
+    std::exception_ptr exception_;
+    bool stop_ = false;
+
+    static thread_local bool is_worker_thread_;
+};
+
+thread_local bool WorkerPool::is_worker_thread_ = false;
+
+void ParallelFor(const size_t count, const size_t min_count_per_thread, const std::function<void(size_t, size_t)>& function) {
+    WorkerPool& pool = WorkerPool::Get();
+    size_t threads_count = (std::min)(pool.GetThreadsCount(), (count + min_count_per_thread - 1) / min_count_per_thread);
+    if (threads_count <= 1) {
+        function(0, count);
+        return;
+    }
+
+    size_t range_size = (count + threads_count - 1) / threads_count;
+    size_t ranges_count = (count + range_size - 1) / range_size;
+    pool.Run(ranges_count, [&function, range_size, count](const size_t range_index) {
+        size_t begin = range_index * range_size;
+        function(begin, (std::min)(begin + range_size, count));
+    });
+}
+
+CarActions GetKeyboardActions(const KeyboardStatus& keyboard_status) {
+    return CarActions{
+        keyboard_status[GL::Key::W],
+        keyboard_status[GL::Key::S],
+        keyboard_status[GL::Key::A],
+        keyboard_status[GL::Key::D]
+    };
+}
+
 std::string GetLastSavedFileWithPrefix(const std::string& path, const std::string& prefix) {
     std::filesystem::file_time_type ans_last_mod_time;
     std::string ans{};
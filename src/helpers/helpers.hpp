@@ -1,6 +1,10 @@
 #pragma once
 
 // STL
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <unordered_map>
@@ -8,6 +12,9 @@
 #include <optional>
 #include <chrono>
 #include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 // OpenGL Wrapper
 #include <GL/OOGL.hpp>
@@ -24,11 +31,12 @@
 #include <window/window.hpp>
 
 // Incomplete type resolve
-#include <car_model/car_model_fwd.hpp>
+#include <car_state/car_state_fwd.hpp>
 #include <skybox/skybox_fwd.hpp>
 
 namespace App {
 
+// Mesh space box with its transforms (160 bytes), intersection queries take the world bounds or OrientedBoxes made from it
 struct MemoryAlignedBBox {
     MemoryAlignedBBox(const GL::Vec3& new_min, const GL::Vec3& new_max,
         const GL::Mat4& new_model, const GL::Mat4& new_mesh_to_model);
@@ -40,8 +48,9 @@ struct MemoryAlignedBBox {
 };
 
 /*
-    Singleton class to share
-    application resources between files
+    Singleton class to share application (window, input
+    and rendering) resources between files, simulation
+    state lives in World objects instead
 */
 struct Context {
 public:
@@ -52,26 +61,15 @@ public:
 
     std::optional<std::reference_wrapper<GL::Context>> gl;
     std::optional<ShaderHandler> shader_handler;
+    std::optional<ComputeTileSizes> compute_tile_sizes;
     std::optional<Camera> camera;
     std::optional<GL::Mat4> projection_matrix;
     std::optional<KeyboardMode> keyboard_mode;
     std::optional<KeyboardStatus> keyboard_status;
     std::optional<CustomWindow> window;
 
-    std::shared_ptr<CarModel> car_model;
     std::shared_ptr<Skybox> skybox;
     std::vector<std::shared_ptr<Model>> env;
-    std::vector<std::shared_ptr<Model>> obstacles;
-
-    // INPUT TO NEURAL NETWORK
-    std::array<float, APP_RAY_INTERSECTOR_RAYS_COUNT> distances_from_rays;
-    std::array<float, APP_CAR_STATE_PARAMETERS_COUNT> state;
-
-    // OUTPUT FROM NEURAL NETWORK
-    std::array<bool, APP_CAR_ACTIONS_COUNT> actions;
-    std::array<bool, APP_CAR_ACTIONS_COUNT> user_selected_actions; // TODO: for supervides learning (should get rid of it)
-
-    void ClearCarTransform();
 
 private:
     Context();
@@ -79,6 +77,36 @@ private:
 
 GL::Vec3 GetTranslation(const GL::Mat4& matrix);
 
+// Inverse of the rotation, scale and translation matrix (the last row has to be 0, 0, 0, 1)
+GL::Mat4 GetAffineInverse(const GL::Mat4& matrix);
+
+// World space axis-aligned bounds of all 8 transformed corners of the box
+void GetWorldBounds(const MemoryAlignedBBox& bbox, GL::Vec3& min_point, GL::Vec3& max_point);
+
+// Inserted right after the #version line, so shaders may be configured at load time
+std::string AddShaderDefine(const std::string& source, const std::string& name, const int value);
+
+// Largest tile (1D workgroup) the device can run, not greater than requested
+int GetMaxComputeTileSize(const int requested_tile_size);
+
+// local_size_x of the linked compute program, queried from the driver once when the shader is loaded
+int GetComputeTileSize(const GL::Program& program);
+
+// Tile size cached for the compute shader at load time, no GL calls
+int GetComputeTileSize(const std::string& shader_name);
+
+// Workgroups needed to cover all the items, one tile each
+GLuint GetComputeTilesCount(const size_t items_count, const int tile_size);
+
+/*
+    Splits [0, count) into contiguous ranges, one per hardware thread, every thread gets at least min_count_per_thread items.
+    Ranges run on a persistent pool together with the calling thread, the first exception is rethrown after all of them finish
+*/
+void ParallelFor(const size_t count, const size_t min_count_per_thread, const std::function<void(size_t, size_t)>& function);
+
+// W, S, A, D keys mapped to the car actions
+CarActions GetKeyboardActions(const KeyboardStatus& keyboard_status);
+
 std::string GetLastSavedFileWithPrefix(const std::string& path, const std::string& prefix);
 std::string GetFilenameFromPath(const std::string& path);
 std::string GetFolderFromPath(const std::string& path);
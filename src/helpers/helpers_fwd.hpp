@@ -7,6 +7,7 @@ namespace App {
 
 using KeyboardStatus = std::array<bool, APP_KEYBOARD_KEYS_COUNT>;
 using ShaderHandler = std::unordered_map<std::string, std::shared_ptr<GL::Program>>;
+using ComputeTileSizes = std::unordered_map<std::string, int>; // by compute shader name
 
 struct MemoryAlignedBBox;
 struct Context;
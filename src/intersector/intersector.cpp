@@ -4,53 +4,322 @@ namespace App {
 
 // Extern variables
 extern const int APP_INTERSECTOR_NUM_GROUPS_Z_COUNT;
-extern const float APP_INTERSECTOR_INTERSECTION_FOUND;
-extern const float APP_INTERSECTOR_INTERSECTION_NOT_FOUND;
+extern const int APP_INTERSECTOR_MAX_COLLISIONS_COUNT;
+extern const float APP_INTERSECTOR_CONTACT_SKIN;
+extern const float APP_GJK_RELATIVE_TOLERANCE;
 
-CollisionIntersector::CollisionIntersector(const std::string& intersect_shader_name)
-    : intersect_shader_name_(intersect_shader_name) {}
+extern const char* intersector_backends[static_cast<size_t>(IntersectorBackend::SIZE)];
 
-CollisionIntersector::CollisionIntersector(const Config::IntersectorConfig& config)
-    : CollisionIntersector(config.shader.compute_shader_name) {}
+// Touching boxes overlap, same as in the other backends
+static bool BoundsOverlap(const ObstacleBounds& lhs, const size_t lhs_index, const ObstacleBounds& rhs, const size_t rhs_index) {
+    return (lhs.min_x[lhs_index] <= rhs.max_x[rhs_index]) && (rhs.min_x[rhs_index] <= lhs.max_x[lhs_index])
+        && (lhs.min_y[lhs_index] <= rhs.max_y[rhs_index]) && (rhs.min_y[rhs_index] <= lhs.max_y[lhs_index])
+        && (lhs.min_z[lhs_index] <= rhs.max_z[rhs_index]) && (rhs.min_z[rhs_index] <= lhs.max_z[lhs_index]);
+}
 
-void CollisionIntersector::ClearObstacles() {
-    obstacle_bboxes_.clear();
-    current_obstacle_index_ = 0;
+static void CollectWorldBounds(const std::vector<MemoryAlignedBBox>& bboxes, ObstacleBounds& bounds) {
+    bounds.Clear();
+    for (const auto& bbox : bboxes) {
+        GL::Vec3 min_point{};
+        GL::Vec3 max_point{};
+        GetWorldBounds(bbox, min_point, max_point);
+        bounds.Add(min_point, max_point);
+    }
 }
 
-void CollisionIntersector::AddObstacles(const Model* model) {
-    std::vector<MemoryAlignedBBox> new_obstacle_bboxes = model->CollectMABB();
-    obstacle_bboxes_.reserve(obstacle_bboxes_.size() + new_obstacle_bboxes.size());
+CollisionIntersector::CollisionIntersector(const std::string& intersect_shader_name, const IntersectorBackend backend)
+    : obstacle_registry_(std::make_shared<ObstacleRegistry>()), obstacle_ssbo_(0), car_parts_ssbo_(1), intersection_result_ssbo_(2),
+    intersect_shader_name_(intersect_shader_name), backend_(backend) {
+    if (backend_ == IntersectorBackend::GRID) {
+        throw std::runtime_error(std::string("CollisionIntersector: ") + intersector_backends[static_cast<size_t>(backend_)] + " backend is available only for rays");
+    }
+}
 
-    for (int bbox_index = 0; bbox_index < new_obstacle_bboxes.size(); ++bbox_index) {
-        obstacle_bboxes_.push_back(new_obstacle_bboxes[bbox_index]);
-        obstacle_index_to_model_index_mesh_index[obstacle_bboxes_.size() - 1] = std::make_pair(current_obstacle_index_, bbox_index);
+CollisionIntersector::CollisionIntersector(const Config::IntersectorConfig& config)
+    : CollisionIntersector(config.shader.compute_shader_name, config.backend) {
+    // The car is moved only if the precomputed state is free of collisions, stale results would let it pass through obstacles
+    if (config.readback_latency != 0) {
+        throw std::runtime_error("CollisionIntersector: collisions are always read back synchronously");
     }
-    ++current_obstacle_index_;
+    SetOrientedNarrowphase(config.oriented_narrowphase);
+    SetConvexHullNarrowphase(config.convex_hull_narrowphase);
+    SetPenetrationDepths(config.penetration_depths);
+    SetContinuous(config.continuous);
+}
+
+void CollisionIntersector::SetOrientedNarrowphase(const bool enabled) {
+    if (enabled && (backend_ == IntersectorBackend::GPU)) {
+        throw std::runtime_error("CollisionIntersector: oriented narrowphase is supported by CPU backends only");
+    }
+    oriented_narrowphase_ = enabled;
+}
+
+void CollisionIntersector::SetConvexHullNarrowphase(const bool enabled) {
+    if (enabled && (backend_ == IntersectorBackend::GPU)) {
+        throw std::runtime_error("CollisionIntersector: convex hull narrowphase is supported by CPU backends only");
+    }
+    convex_hull_narrowphase_ = enabled;
+}
+
+void CollisionIntersector::SetObstacleRegistry(std::shared_ptr<ObstacleRegistry> obstacle_registry) {
+    obstacle_registry_ = std::move(obstacle_registry);
+    obstacle_bvh_version_ = 0;
+    obstacle_ssbo_version_ = 0;
+    obstacle_sweep_.Clear();
 }
 
 void CollisionIntersector::ClearCarParts() {
     car_parts_bboxes_.clear();
-    current_car_part_index_ = 0;
+    car_parts_convex_hulls_.clear();
+    car_part_offsets_.resize(1);
+    car_group_offsets_.resize(1);
+    car_group_parts_.clear();
 }
 
 void CollisionIntersector::AddCarParts(const CarModel* car_model) {
     std::vector<MemoryAlignedBBox> new_car_parts_bboxes = car_model->CollectMABB();
-    car_parts_bboxes_.reserve(car_parts_bboxes_.size() + new_car_parts_bboxes.size());
+    const int first_car_part = static_cast<int>(car_parts_bboxes_.size());
+    car_parts_bboxes_.insert(car_parts_bboxes_.end(), new_car_parts_bboxes.begin(), new_car_parts_bboxes.end());
+    car_part_offsets_.push_back(static_cast<int>(car_parts_bboxes_.size()));
+
+    std::vector<ConvexHullInstance> new_car_parts_convex_hulls = car_model->CollectConvexHulls();
+    car_parts_convex_hulls_.insert(car_parts_convex_hulls_.end(), new_car_parts_convex_hulls.begin(), new_car_parts_convex_hulls.end());
 
-    for (int bbox_index = 0; bbox_index < new_car_parts_bboxes.size(); ++bbox_index) {
-        car_parts_bboxes_.push_back(new_car_parts_bboxes[bbox_index]);
-        car_part_index_to_model_index_mesh_index[car_parts_bboxes_.size() - 1] = std::make_pair(current_car_part_index_, bbox_index);
+    const std::vector<int>& mesh_groups = car_model->GetMeshCollisionGroups();
+    const int meshes_count = static_cast<int>(new_car_parts_bboxes.size());
+    for (int group = 0; group < static_cast<int>(CarCollisionGroup::SIZE); ++group) {
+        for (int mesh_index = 0; mesh_index < meshes_count; ++mesh_index) {
+            if (mesh_groups[mesh_index] == group) {
+                car_group_parts_.push_back(first_car_part + mesh_index);
+            }
+        }
+        car_group_offsets_.push_back(static_cast<int>(car_group_parts_.size()));
+    }
+}
+
+void CollisionIntersector::SetCarModelMatrix(const int car_index, const GL::Mat4& model_matrix) {
+    for (int car_parts_id = car_part_offsets_[car_index]; car_parts_id < car_part_offsets_[car_index + 1]; ++car_parts_id) {
+        MemoryAlignedBBox& car_part_bbox = car_parts_bboxes_[car_parts_id];
+        car_part_bbox.model = model_matrix;
+        // Hulls use the same mesh transform as the boxes
+        car_parts_convex_hulls_[car_parts_id].mesh_to_world = model_matrix * car_part_bbox.mesh_to_model;
     }
-    ++current_car_part_index_;
 }
 
 void CollisionIntersector::Intersect() {
-    // TODO: get rid of magic numbers
-    // TODO: fix code (with SubData) instead of generating buffer object every frame
-    // TODO: fix SubData and GetSubData in OOGL (check if they need glBindBufferBase)
-    std::vector<int> obstacles_collided_ids{};
-    std::vector<int> car_parts_collided_ids{};
+    obstacle_registry_->Update();
+    penetration_depths_.clear();
+    if (backend_ == IntersectorBackend::CPU_SIMD) {
+        IntersectCPU();
+    } else if (backend_ == IntersectorBackend::CPU_SWEEP) {
+        IntersectSweep();
+    } else {
+        IntersectGPU();
+    }
+    UpdateHitLists();
+}
+
+float CollisionIntersector::IntersectSwept(const std::vector<MemoryAlignedBBox>& start_car_parts_bboxes) {
+    if (start_car_parts_bboxes.size() != car_parts_bboxes_.size()) {
+        throw std::runtime_error("CollisionIntersector: swept car parts don't match the added ones");
+    }
+    obstacle_registry_->Update();
+    UpdateObstacleBvh();
+    UpdateCarBounds();
+    CollectWorldBounds(start_car_parts_bboxes, swept_start_bounds_);
+
+    const ObstacleBounds& obstacle_bounds = obstacle_registry_->GetBounds();
+    const std::vector<float>* obstacle_min[3] = {&obstacle_bounds.min_x, &obstacle_bounds.min_y, &obstacle_bounds.min_z};
+    const std::vector<float>* obstacle_max[3] = {&obstacle_bounds.max_x, &obstacle_bounds.max_y, &obstacle_bounds.max_z};
+    const std::vector<float>* start_min[3] = {&swept_start_bounds_.min_x, &swept_start_bounds_.min_y, &swept_start_bounds_.min_z};
+    const std::vector<float>* start_max[3] = {&swept_start_bounds_.max_x, &swept_start_bounds_.max_y, &swept_start_bounds_.max_z};
+    const std::vector<float>* end_min[3] = {&car_parts_bounds_.min_x, &car_parts_bounds_.min_y, &car_parts_bounds_.min_z};
+    const std::vector<float>* end_max[3] = {&car_parts_bounds_.max_x, &car_parts_bounds_.max_y, &car_parts_bounds_.max_z};
+
+    collisions_.clear();
+    penetration_depths_.clear();
+    float first_contact = 1.0f;
+
+    const int cars_count = static_cast<int>(car_part_offsets_.size()) - 1;
+    for (int car_index = 0; car_index < cars_count; ++car_index) {
+        // Whole motion of the car goes first, its parts are swept only if there are obstacles on the way
+        float car_min[3] = {std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()};
+        float car_max[3] = {-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+        for (int car_parts_id = car_part_offsets_[car_index]; car_parts_id < car_part_offsets_[car_index + 1]; ++car_parts_id) {
+            for (int axis = 0; axis < 3; ++axis) {
+                car_min[axis] = (std::min)(car_min[axis], (std::min)((*start_min[axis])[car_parts_id], (*end_min[axis])[car_parts_id]));
+                car_max[axis] = (std::max)(car_max[axis], (std::max)((*start_max[axis])[car_parts_id], (*end_max[axis])[car_parts_id]));
+            }
+        }
+        query_obstacle_ids_.clear();
+        obstacle_bvh_.QueryOverlaps(GL::Vec3{car_min[0], car_min[1], car_min[2]}, GL::Vec3{car_max[0], car_max[1], car_max[2]}, query_obstacle_ids_);
+        if (query_obstacle_ids_.empty()) {
+            continue;
+        }
+
+        for (int car_parts_id = car_part_offsets_[car_index]; car_parts_id < car_part_offsets_[car_index + 1]; ++car_parts_id) {
+            // Center of the box moves along the segment, obstacles are grown by its half sizes
+            float center[3];
+            float motion[3];
+            float half_sizes[3];
+            float swept_min[3];
+            float swept_max[3];
+            float motion_length = 0.0f;
+            for (int axis = 0; axis < 3; ++axis) {
+                float part_start_min = (*start_min[axis])[car_parts_id];
+                float part_start_max = (*start_max[axis])[car_parts_id];
+                float part_end_min = (*end_min[axis])[car_parts_id];
+                float part_end_max = (*end_max[axis])[car_parts_id];
+                center[axis] = 0.5f * (part_start_min + part_start_max);
+                motion[axis] = 0.5f * (part_end_min + part_end_max) - center[axis];
+                half_sizes[axis] = 0.5f * (std::max)(part_start_max - part_start_min, part_end_max - part_end_min);
+                swept_min[axis] = (std::min)(part_start_min, part_end_min);
+                swept_max[axis] = (std::max)(part_start_max, part_end_max);
+                motion_length += motion[axis] * motion[axis];
+            }
+            motion_length = std::sqrt(motion_length);
+
+            for (auto obstacle_id : query_obstacle_ids_) {
+                // Overlap at the start is decided by the real start box, the grown one is larger when the car turns
+                if (BoundsOverlap(swept_start_bounds_, car_parts_id, obstacle_bounds, obstacle_id)) {
+                    continue;
+                }
+                float enter = -std::numeric_limits<float>::infinity();
+                float exit = std::numeric_limits<float>::infinity();
+                for (int axis = 0; axis < 3; ++axis) {
+                    float obstacle_low = (*obstacle_min[axis])[obstacle_id];
+                    float obstacle_high = (*obstacle_max[axis])[obstacle_id];
+                    if ((swept_max[axis] < obstacle_low) || (obstacle_high < swept_min[axis])) {
+                        enter = std::numeric_limits<float>::infinity();
+                        break;
+                    }
+                    float low = obstacle_low - half_sizes[axis];
+                    float high = obstacle_high + half_sizes[axis];
+                    if (motion[axis] == 0.0f) {
+                        if ((center[axis] < low) || (high < center[axis])) {
+                            enter = std::numeric_limits<float>::infinity();
+                        }
+                        continue;
+                    }
+                    float first = (low - center[axis]) / motion[axis];
+                    float second = (high - center[axis]) / motion[axis];
+                    enter = (std::max)(enter, (std::min)(first, second));
+                    exit = (std::min)(exit, (std::max)(first, second));
+                }
+                // Grown box touching at the start is caused only by the rotation, the final pose is checked by Intersect
+                if ((enter > exit) || (enter <= 0.0f) || (enter >= 1.0f)) {
+                    continue;
+                }
+
+                float contact = (std::max)(0.0f, enter - APP_INTERSECTOR_CONTACT_SKIN / motion_length);
+                if (contact < first_contact) {
+                    first_contact = contact;
+                    collisions_.clear();
+                }
+                if (contact == first_contact) {
+                    collisions_.push_back(CollisionPair{obstacle_id, car_parts_id});
+                }
+            }
+        }
+    }
+    UpdateHitLists();
+    return first_contact;
+}
+
+float CollisionIntersector::GetConvexHullsDistance(const std::vector<MemoryAlignedBBox>& end_car_parts_bboxes, const float contact_distance) {
+    if (end_car_parts_bboxes.size() != car_parts_bboxes_.size()) {
+        throw std::runtime_error("CollisionIntersector: swept car parts don't match the added ones");
+    }
+    obstacle_registry_->Update();
+    UpdateObstacleBvh();
+    UpdateCarBounds();
+    CollectWorldBounds(end_car_parts_bboxes, swept_end_bounds_);
+
+    const ObstacleBounds& obstacle_bounds = obstacle_registry_->GetBounds();
+    const std::vector<ConvexHullInstance>& obstacle_convex_hulls = obstacle_registry_->GetConvexHulls();
+    collisions_.clear();
+    penetration_depths_.clear();
+    float min_distance = std::numeric_limits<float>::infinity();
+
+    const int car_parts_count = static_cast<int>(car_parts_bboxes_.size());
+    for (int car_parts_id = 0; car_parts_id < car_parts_count; ++car_parts_id) {
+        query_obstacle_ids_.clear();
+        obstacle_bvh_.QueryOverlaps(
+            GL::Vec3{
+                (std::min)(car_parts_bounds_.min_x[car_parts_id], swept_end_bounds_.min_x[car_parts_id]),
+                (std::min)(car_parts_bounds_.min_y[car_parts_id], swept_end_bounds_.min_y[car_parts_id]),
+                (std::min)(car_parts_bounds_.min_z[car_parts_id], swept_end_bounds_.min_z[car_parts_id])
+            },
+            GL::Vec3{
+                (std::max)(car_parts_bounds_.max_x[car_parts_id], swept_end_bounds_.max_x[car_parts_id]),
+                (std::max)(car_parts_bounds_.max_y[car_parts_id], swept_end_bounds_.max_y[car_parts_id]),
+                (std::max)(car_parts_bounds_.max_z[car_parts_id], swept_end_bounds_.max_z[car_parts_id])
+            },
+            query_obstacle_ids_
+        );
+
+        for (auto obstacle_id : query_obstacle_ids_) {
+            GL::Vec3 initial_direction{
+                (car_parts_bounds_.min_x[car_parts_id] + car_parts_bounds_.max_x[car_parts_id]) - (obstacle_bounds.min_x[obstacle_id] + obstacle_bounds.max_x[obstacle_id]),
+                (car_parts_bounds_.min_y[car_parts_id] + car_parts_bounds_.max_y[car_parts_id]) - (obstacle_bounds.min_y[obstacle_id] + obstacle_bounds.max_y[obstacle_id]),
+                (car_parts_bounds_.min_z[car_parts_id] + car_parts_bounds_.max_z[car_parts_id]) - (obstacle_bounds.min_z[obstacle_id] + obstacle_bounds.max_z[obstacle_id])
+            };
+            ConvexHullsContact contact = IntersectConvexHulls(obstacle_convex_hulls[obstacle_id], car_parts_convex_hulls_[car_parts_id], initial_direction);
+            if (contact.is_intersecting) {
+                continue;
+            }
+
+            // Distance of GJK may exceed the true one by its tolerance
+            float distance = contact.distance * (1.0f - APP_GJK_RELATIVE_TOLERANCE);
+            min_distance = (std::min)(min_distance, distance);
+            if (distance <= contact_distance) {
+                collisions_.push_back(CollisionPair{obstacle_id, car_parts_id});
+            }
+        }
+    }
+    UpdateHitLists();
+    return min_distance;
+}
+
+void CollisionIntersector::IntersectGPU() {
+    collisions_.clear();
+
+    // Whole cars are checked on CPU first, without contacts there is no dispatch and no readback
+    UpdateObstacleBvh();
+    UpdateCarBounds();
+    bool is_any_car_near = false;
+    for (size_t car_index = 0; (car_index < cars_bounds_.GetSize()) && !is_any_car_near; ++car_index) {
+        query_obstacle_ids_.clear();
+        obstacle_bvh_.QueryOverlaps(
+            GL::Vec3{cars_bounds_.min_x[car_index], cars_bounds_.min_y[car_index], cars_bounds_.min_z[car_index]},
+            GL::Vec3{cars_bounds_.max_x[car_index], cars_bounds_.max_y[car_index], cars_bounds_.max_z[car_index]},
+            query_obstacle_ids_
+        );
+        is_any_car_near = !query_obstacle_ids_.empty();
+    }
+    if (!is_any_car_near) {
+        return;
+    }
+
+    // Obstacles are uploaded only after they change
+    obstacle_registry_->WriteWorldBBoxes(obstacle_ssbo_, obstacle_ssbo_version_);
+
+    // Car parts go as their world bounds computed above, 32 bytes per box instead of the mesh box with two matrices
+    car_parts_world_bboxes_.clear();
+    for (size_t car_parts_id = 0; car_parts_id < car_parts_bounds_.GetSize(); ++car_parts_id) {
+        car_parts_world_bboxes_.push_back(WorldBBox{
+            GL::Vec4{car_parts_bounds_.min_x[car_parts_id], car_parts_bounds_.min_y[car_parts_id], car_parts_bounds_.min_z[car_parts_id], 1.0f},
+            GL::Vec4{car_parts_bounds_.max_x[car_parts_id], car_parts_bounds_.max_y[car_parts_id], car_parts_bounds_.max_z[car_parts_id], 1.0f}
+        });
+    }
+    car_parts_ssbo_.Reserve(car_parts_world_bboxes_.size() * sizeof(WorldBBox));
+    car_parts_ssbo_.Write(car_parts_world_bboxes_.data(), car_parts_world_bboxes_.size() * sizeof(WorldBBox));
+
+    // Header followed by (obstacle_id, car_parts_id) pairs, size doesn't depend on the scene
+    intersection_result_ssbo_.Reserve(sizeof(CollisionResultsHeader) + 2 * APP_INTERSECTOR_MAX_COLLISIONS_COUNT * sizeof(std::uint32_t));
+    auto* header = intersection_result_ssbo_.GetData<CollisionResultsHeader>();
+    header->collisions_count = 0;
+    header->collisions_capacity = APP_INTERSECTOR_MAX_COLLISIONS_COUNT;
 
     auto& context = App::Context::Get();
     auto& gl = context.gl->get();
@@ -58,32 +327,269 @@ void CollisionIntersector::Intersect() {
 
     auto intersect_program = shader_handler.at(intersect_shader_name_);
     gl.UseProgram(*intersect_program);
+    intersect_program->SetUniform(intersect_program->GetUniform("obstacles_count"), static_cast<int>(obstacle_registry_->GetBoxesCount()));
+    intersect_program->SetUniform(intersect_program->GetUniform("car_parts_count"), static_cast<int>(car_parts_bboxes_.size()));
 
-    auto obstacle_ssbo = GL::StorageBuffer(obstacle_bboxes_.data(), obstacle_bboxes_.size() * sizeof(MemoryAlignedBBox), GL::BufferUsage::StaticRead, 0);
-    auto car_parts_ssbo = GL::StorageBuffer(car_parts_bboxes_.data(), car_parts_bboxes_.size() * sizeof(MemoryAlignedBBox), GL::BufferUsage::StaticRead, 1);
+    obstacle_ssbo_.Bind();
+    car_parts_ssbo_.Bind();
+    intersection_result_ssbo_.Bind();
 
-    std::vector<float> intersection_results(obstacle_bboxes_.size() * car_parts_bboxes_.size(), APP_INTERSECTOR_INTERSECTION_NOT_FOUND);
-    auto intersection_result_ssbo = GL::StorageBuffer(intersection_results.data(), intersection_results.size() * sizeof(float), GL::BufferUsage::DynamicDraw, 2);
-
-    // Execute compute shader
-    gl.DispatchCompute(obstacle_bboxes_.size(), car_parts_bboxes_.size(), APP_INTERSECTOR_NUM_GROUPS_Z_COUNT);
+    // Execute compute shader: tiles of obstacles along X, tiles of car parts along Y
+    int tile_size = GetComputeTileSize(intersect_shader_name_);
+    gl.DispatchCompute(GetComputeTilesCount(obstacle_registry_->GetBoxesCount(), tile_size), GetComputeTilesCount(car_parts_bboxes_.size(), tile_size), APP_INTERSECTOR_NUM_GROUPS_Z_COUNT);
     gl.Barrier(GL::BarrierBit::All);
 
     // Get the results back on CPU
-    auto read_data = intersection_result_ssbo.Map<float>(GL::BufferAccess::ReadOnly);
+    WaitForGpuCommands();
+    const std::uint32_t* collisions = intersection_result_ssbo_.GetData<std::uint32_t>() + sizeof(CollisionResultsHeader) / sizeof(std::uint32_t);
+
+    // WARNING: pairs over the capacity are lost, but the car is stopped by any collision anyway
+    std::uint32_t collisions_count = (std::min)(header->collisions_count, header->collisions_capacity);
+    for (std::uint32_t collision_index = 0; collision_index < collisions_count; ++collision_index) {
+        collisions_.push_back(CollisionPair{static_cast<int>(collisions[2 * collision_index]), static_cast<int>(collisions[2 * collision_index + 1])});
+    }
+}
+
+void CollisionIntersector::UpdateObstacleBvh() {
+    if (obstacle_bvh_version_ != obstacle_registry_->GetVersion()) {
+        obstacle_bvh_.Build(obstacle_registry_->GetBounds());
+        obstacle_bvh_version_ = obstacle_registry_->GetVersion();
+    }
+}
 
-    float sum = 0;
-    for (int i = 0; i < intersection_results.size(); ++i) {
-        if (read_data[i] == APP_INTERSECTOR_INTERSECTION_FOUND) {
-            // i = obstacle_id * car_parts_size + car_parts_id
-            int obstacle_id = i / car_parts_bboxes_.size();
-            obstacles_collided_ids.push_back(obstacle_id);
+void CollisionIntersector::IntersectCPU() {
+    UpdateObstacleBvh();
+    UpdateCarBounds();
 
-            int car_parts_id = i % car_parts_bboxes_.size();
-            car_parts_collided_ids.push_back(car_parts_id);
+    collisions_.clear();
+
+    // One BVH query per car, its groups and parts are checked only with the obstacles found there
+    const int cars_count = static_cast<int>(cars_bounds_.GetSize());
+    for (int car_index = 0; car_index < cars_count; ++car_index) {
+        query_obstacle_ids_.clear();
+        obstacle_bvh_.QueryOverlaps(
+            GL::Vec3{cars_bounds_.min_x[car_index], cars_bounds_.min_y[car_index], cars_bounds_.min_z[car_index]},
+            GL::Vec3{cars_bounds_.max_x[car_index], cars_bounds_.max_y[car_index], cars_bounds_.max_z[car_index]},
+            query_obstacle_ids_
+        );
+        for (auto obstacle_id : query_obstacle_ids_) {
+            CollectCarCollisions(car_index, obstacle_id);
+        }
+    }
+    if (oriented_narrowphase_) {
+        FilterOrientedPairs();
+    }
+    if (convex_hull_narrowphase_) {
+        FilterConvexHullPairs();
+    }
+}
+
+void CollisionIntersector::IntersectSweep() {
+    UpdateCarBounds();
+
+    const ObstacleBounds& obstacle_bounds = obstacle_registry_->GetBounds();
+    obstacle_sweep_.Update(obstacle_bounds, cars_bounds_);
+
+    collisions_.clear();
+
+    for (const auto& pair : obstacle_sweep_.GetPairs()) {
+        if (BoundsOverlap(obstacle_bounds, pair.obstacle_index, cars_bounds_, pair.car_index)) {
+            CollectCarCollisions(pair.car_index, pair.obstacle_index);
+        }
+    }
+    if (oriented_narrowphase_) {
+        FilterOrientedPairs();
+    }
+    if (convex_hull_narrowphase_) {
+        FilterConvexHullPairs();
+    }
+}
+
+void CollisionIntersector::UpdateCarBounds() {
+    CollectWorldBounds(car_parts_bboxes_, car_parts_bounds_);
+
+    // Empty groups get inverted bounds, so they never overlap anything
+    const GL::Vec3 empty_min_point{std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()};
+    const GL::Vec3 empty_max_point{-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+    const int groups_count = static_cast<int>(CarCollisionGroup::SIZE);
+
+    car_groups_bounds_.Clear();
+    cars_bounds_.Clear();
+    const int cars_count = static_cast<int>(car_part_offsets_.size()) - 1;
+    for (int car_index = 0; car_index < cars_count; ++car_index) {
+        GL::Vec3 car_min_point = empty_min_point;
+        GL::Vec3 car_max_point = empty_max_point;
+        for (int group = car_index * groups_count; group < (car_index + 1) * groups_count; ++group) {
+            GL::Vec3 group_min_point = empty_min_point;
+            GL::Vec3 group_max_point = empty_max_point;
+            for (int part_position = car_group_offsets_[group]; part_position < car_group_offsets_[group + 1]; ++part_position) {
+                int car_parts_id = car_group_parts_[part_position];
+                group_min_point = GL::Vec3{
+                    (std::min)(group_min_point.X, car_parts_bounds_.min_x[car_parts_id]),
+                    (std::min)(group_min_point.Y, car_parts_bounds_.min_y[car_parts_id]),
+                    (std::min)(group_min_point.Z, car_parts_bounds_.min_z[car_parts_id])
+                };
+                group_max_point = GL::Vec3{
+                    (std::max)(group_max_point.X, car_parts_bounds_.max_x[car_parts_id]),
+                    (std::max)(group_max_point.Y, car_parts_bounds_.max_y[car_parts_id]),
+                    (std::max)(group_max_point.Z, car_parts_bounds_.max_z[car_parts_id])
+                };
+            }
+            car_groups_bounds_.Add(group_min_point, group_max_point);
+            car_min_point = GL::Vec3{(std::min)(car_min_point.X, group_min_point.X), (std::min)(car_min_point.Y, group_min_point.Y), (std::min)(car_min_point.Z, group_min_point.Z)};
+            car_max_point = GL::Vec3{(std::max)(car_max_point.X, group_max_point.X), (std::max)(car_max_point.Y, group_max_point.Y), (std::max)(car_max_point.Z, group_max_point.Z)};
+        }
+        cars_bounds_.Add(car_min_point, car_max_point);
+    }
+}
+
+void CollisionIntersector::CollectCarCollisions(const int car_index, const int obstacle_index) {
+    const ObstacleBounds& obstacle_bounds = obstacle_registry_->GetBounds();
+    const int groups_count = static_cast<int>(CarCollisionGroup::SIZE);
+    for (int group = car_index * groups_count; group < (car_index + 1) * groups_count; ++group) {
+        if (!BoundsOverlap(obstacle_bounds, obstacle_index, car_groups_bounds_, group)) {
+            continue;
+        }
+        for (int part_position = car_group_offsets_[group]; part_position < car_group_offsets_[group + 1]; ++part_position) {
+            int car_parts_id = car_group_parts_[part_position];
+            if (BoundsOverlap(obstacle_bounds, obstacle_index, car_parts_bounds_, car_parts_id)) {
+                collisions_.push_back(CollisionPair{obstacle_index, car_parts_id});
+            }
+        }
+    }
+}
+
+void CollisionIntersector::FilterOrientedPairs() {
+    const OrientedBoxes& obstacle_boxes = obstacle_registry_->GetOrientedBoxes();
+    car_parts_oriented_boxes_.Clear();
+    for (const auto& car_part_bbox : car_parts_bboxes_) {
+        car_parts_oriented_boxes_.Add(GetOrientedBox(car_part_bbox));
+    }
+
+    box_narrowphase_.Clear();
+    narrowphase_pair_indices_.clear();
+    for (size_t pair_index = 0; pair_index < collisions_.size(); ++pair_index) {
+        const int obstacle_index = collisions_[pair_index].obstacle_index;
+        const int car_part_index = collisions_[pair_index].car_part_index;
+        if (!obstacle_boxes.is_axis_aligned[obstacle_index] || !car_parts_oriented_boxes_.is_axis_aligned[car_part_index]) {
+            box_narrowphase_.Add(obstacle_index, car_part_index);
+            narrowphase_pair_indices_.push_back(static_cast<int>(pair_index));
         }
     }
-    results_ = std::make_pair(obstacles_collided_ids, car_parts_collided_ids);
+    if (narrowphase_pair_indices_.empty()) {
+        return;
+    }
+    box_narrowphase_.TestOverlaps(obstacle_boxes, car_parts_oriented_boxes_, narrowphase_overlaps_);
+
+    // Separated pairs are marked and removed in a single pass, so the order of the rest is kept
+    for (size_t tested_index = 0; tested_index < narrowphase_pair_indices_.size(); ++tested_index) {
+        if (!narrowphase_overlaps_[tested_index]) {
+            collisions_[narrowphase_pair_indices_[tested_index]].obstacle_index = -1;
+        }
+    }
+    collisions_.erase(std::remove_if(collisions_.begin(), collisions_.end(), [](const CollisionPair& pair) {
+        return pair.obstacle_index < 0;
+    }), collisions_.end());
+}
+
+void CollisionIntersector::FilterConvexHullPairs() {
+    const ObstacleBounds& obstacle_bounds = obstacle_registry_->GetBounds();
+    const std::vector<ConvexHullInstance>& obstacle_convex_hulls = obstacle_registry_->GetConvexHulls();
+    std::swap(convex_hull_directions_, previous_convex_hull_directions_);
+    convex_hull_directions_.clear();
+    PenetrationBuffers* penetration_buffers = penetration_depths_enabled_ ? &penetration_buffers_ : nullptr;
+
+    // Kept pairs are moved to the front in a single pass, so their order is kept
+    size_t kept_count = 0;
+    for (const auto& pair : collisions_) {
+        const std::uint64_t key = (static_cast<std::uint64_t>(pair.obstacle_index) << 32) | static_cast<std::uint32_t>(pair.car_part_index);
+
+        // New pairs start from the direction between the centers of their bounds
+        GL::Vec3 initial_direction{
+            (car_parts_bounds_.min_x[pair.car_part_index] + car_parts_bounds_.max_x[pair.car_part_index]) - (obstacle_bounds.min_x[pair.obstacle_index] + obstacle_bounds.max_x[pair.obstacle_index]),
+            (car_parts_bounds_.min_y[pair.car_part_index] + car_parts_bounds_.max_y[pair.car_part_index]) - (obstacle_bounds.min_y[pair.obstacle_index] + obstacle_bounds.max_y[pair.obstacle_index]),
+            (car_parts_bounds_.min_z[pair.car_part_index] + car_parts_bounds_.max_z[pair.car_part_index]) - (obstacle_bounds.min_z[pair.obstacle_index] + obstacle_bounds.max_z[pair.obstacle_index])
+        };
+        auto previous_direction = std::lower_bound(previous_convex_hull_directions_.begin(), previous_convex_hull_directions_.end(), key,
+            [](const ConvexHullDirection& entry, const std::uint64_t value) { return entry.key < value; });
+        if ((previous_direction != previous_convex_hull_directions_.end()) && (previous_direction->key == key)) {
+            initial_direction = previous_direction->direction;
+        }
+
+        ConvexHullsContact contact = IntersectConvexHulls(obstacle_convex_hulls[pair.obstacle_index], car_parts_convex_hulls_[pair.car_part_index],
+            initial_direction, penetration_buffers);
+        convex_hull_directions_.push_back(ConvexHullDirection{key, contact.direction});
+        if (contact.is_intersecting) {
+            collisions_[kept_count++] = pair;
+            if (penetration_buffers != nullptr) {
+                penetration_depths_.push_back(contact.penetration_depth);
+            }
+        }
+    }
+    collisions_.resize(kept_count);
+    std::sort(convex_hull_directions_.begin(), convex_hull_directions_.end(),
+        [](const ConvexHullDirection& lhs, const ConvexHullDirection& rhs) { return lhs.key < rhs.key; });
+}
+
+void CollisionIntersector::UpdateHitLists() {
+    for (auto handle : hit_obstacle_handles_) {
+        obstacle_hit_meshes_[handle].clear();
+    }
+    for (auto car_model_index : hit_car_models_) {
+        car_part_hit_meshes_[car_model_index].clear();
+    }
+    hit_obstacle_handles_.clear();
+    hit_car_models_.clear();
+    if (collisions_.empty()) {
+        return;
+    }
+
+    // Flags keep every mesh listed once, they are reset below, so the cost is proportional to the hits
+    obstacle_hit_flags_.resize((std::max)(obstacle_hit_flags_.size(), obstacle_registry_->GetBoxesCount()), 0);
+    car_part_hit_flags_.resize((std::max)(car_part_hit_flags_.size(), car_parts_bboxes_.size()), 0);
+    car_part_hit_meshes_.resize((std::max)(car_part_hit_meshes_.size(), car_part_offsets_.size() - 1));
+
+    for (const auto& collision : collisions_) {
+        if (!obstacle_hit_flags_[collision.obstacle_index]) {
+            obstacle_hit_flags_[collision.obstacle_index] = 1;
+            auto owner = obstacle_registry_->GetBoxOwner(collision.obstacle_index);
+            if (owner.first >= static_cast<int>(obstacle_hit_meshes_.size())) {
+                obstacle_hit_meshes_.resize(owner.first + 1);
+            }
+            if (obstacle_hit_meshes_[owner.first].empty()) {
+                hit_obstacle_handles_.push_back(owner.first);
+            }
+            obstacle_hit_meshes_[owner.first].push_back(owner.second);
+        }
+        if (!car_part_hit_flags_[collision.car_part_index]) {
+            car_part_hit_flags_[collision.car_part_index] = 1;
+            int car_model_index = static_cast<int>(std::upper_bound(car_part_offsets_.begin(), car_part_offsets_.end(), collision.car_part_index) - car_part_offsets_.begin()) - 1;
+            if (car_part_hit_meshes_[car_model_index].empty()) {
+                hit_car_models_.push_back(car_model_index);
+            }
+            car_part_hit_meshes_[car_model_index].push_back(collision.car_part_index - car_part_offsets_[car_model_index]);
+        }
+    }
+    for (const auto& collision : collisions_) {
+        obstacle_hit_flags_[collision.obstacle_index] = 0;
+        car_part_hit_flags_[collision.car_part_index] = 0;
+    }
+}
+
+const std::vector<int>& CollisionIntersector::GetIntersectedObstacleMeshIndices(const int model_index) const {
+    static const std::vector<int> no_hits{};
+    if ((model_index < 0) || (model_index >= static_cast<int>(obstacle_hit_meshes_.size()))) {
+        return no_hits;
+    }
+    return obstacle_hit_meshes_[model_index];
+}
+
+const std::vector<int>& CollisionIntersector::GetIntersectedCarPartMeshIndices(const int model_index) const {
+    static const std::vector<int> no_hits{};
+    if ((model_index < 0) || (model_index >= static_cast<int>(car_part_hit_meshes_.size()))) {
+        return no_hits;
+    }
+    return car_part_hit_meshes_[model_index];
 }
 
 } // namespace App
\ No newline at end of file
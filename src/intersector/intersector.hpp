@@ -1,5 +1,14 @@
 #pragma once
 
+// STL
+#define NOMINMAX
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
 // OpenGL Wrapper
 #include <GL/OOGL.hpp>
 
@@ -12,65 +21,190 @@
 // LibSmartCar
 #include <helpers/helpers.hpp>
 #include <config/config_handler.hpp>
+#include <bvh/bvh.hpp>
+#include <box_narrowphase/box_narrowphase.hpp>
+#include <convex_hull/convex_hull.hpp>
+#include <obstacle_registry/obstacle_registry.hpp>
+#include <sweep_and_prune/sweep_and_prune.hpp>
+#include <persistent_storage_buffer/persistent_storage_buffer.hpp>
 #include <car_model/car_model.hpp>
 
 namespace App {
 
+// WARNING: must match the beginning of IntersetionResultsBlock in collision_intersection.comp
+struct CollisionResultsHeader {
+    std::uint32_t collisions_count;
+    std::uint32_t collisions_capacity;
+};
+
+// Index of the box in the registry and index of the car part among the added ones
+struct CollisionPair {
+    int obstacle_index;
+    int car_part_index;
+};
+
 class CollisionIntersector {
 public:
-    CollisionIntersector(const std::string& intersect_shader_name);
+    CollisionIntersector(const std::string& intersect_shader_name, const IntersectorBackend backend = IntersectorBackend::GPU);
     CollisionIntersector(const Config::IntersectorConfig& config);
 
-    void ClearObstacles();
-    void AddObstacles(const Model* model);
+    // Obstacles are kept in the registry, which may be shared with other sensors of the world
+    void SetObstacleRegistry(std::shared_ptr<ObstacleRegistry> obstacle_registry);
+    std::shared_ptr<ObstacleRegistry> GetObstacleRegistry() const { return obstacle_registry_; }
+
+    /*
+        CPU backends only: pairs with overlapping world bounds are checked by the separating axis test
+        of the oriented boxes, so rotated car parts and obstacles collide only when their boxes really overlap
+    */
+    void SetOrientedNarrowphase(const bool enabled);
+
+    /*
+        CPU backends only: the remaining pairs are checked by GJK on the convex hulls of the meshes,
+        so cars stop at the visual contact instead of the box one. Directions found for every pair start the next call
+    */
+    void SetConvexHullNarrowphase(const bool enabled);
+    bool IsConvexHullNarrowphase() const { return convex_hull_narrowphase_; }
+
+    // EPA runs for the colliding pairs of the convex hull narrowphase only if the depths are requested
+    void SetPenetrationDepths(const bool enabled) { penetration_depths_enabled_ = enabled; }
+
+    // Car is moved by swept checks, see IntersectSwept
+    void SetContinuous(const bool enabled) { continuous_ = enabled; }
+    bool IsContinuous() const { return continuous_; }
 
     void ClearCarParts();
     void AddCarParts(const CarModel* car_model);
 
+    // Parts of the car_index-th added car model are moved to the model matrix in place, their meshes stay the same
+    void SetCarModelMatrix(const int car_index, const GL::Mat4& model_matrix);
+
     void Intersect();
 
-    std::vector<int> GetIntersectedObstacleMeshIndices(const int model_index) const {
-        std::vector<int> intersected_obstacle_mesh_indices{};
-        for (auto obstacle_index : results_.first) {
-            auto result = obstacle_index_to_model_index_mesh_index.at(obstacle_index);
-            if (result.first == model_index) {
-                intersected_obstacle_mesh_indices.push_back(result.second);
-            }
-        }
-        return intersected_obstacle_mesh_indices;
-    }
-
-    std::vector<int> GetIntersectedCarPartMeshIndices(const int model_index) const {
-        std::vector<int> intersected_car_part_mesh_indices{};
-        for (auto car_part_index : results_.second) {
-            auto result = car_part_index_to_model_index_mesh_index.at(car_part_index);
-            if (result.first == model_index) {
-                intersected_car_part_mesh_indices.push_back(result.second);
-            }
-        }
-        return intersected_car_part_mesh_indices;
-    }
+    /*
+        Car parts are moved from the start boxes to the added ones (same order), returns the fraction of the motion
+        that can be made before the first contact (1 if there is none) and keeps the pairs touching there as the results.
+        World bounds are swept linearly against the obstacle BVH with every backend.
+        WARNING: pairs whose start bounds overlap are skipped, so the car can move away from a contact,
+        check the final pose with Intersect. Rotation during the step is covered only by the larger of the start and end bounds,
+        pairs whose grown box touches the obstacle already at the start are left to Intersect as well
+    */
+    float IntersectSwept(const std::vector<MemoryAlignedBBox>& start_car_parts_bboxes);
+
+    /*
+        Smallest distance between the convex hulls of the added car parts and the obstacles found by the bounds
+        swept to the end boxes (same order as the added ones), infinity if there are none. Distance never exceeds the true one.
+        Pairs whose hulls already intersect are skipped as in IntersectSwept, pairs closer than contact_distance are kept as the results
+    */
+    float GetConvexHullsDistance(const std::vector<MemoryAlignedBBox>& end_car_parts_bboxes, const float contact_distance);
+
+    IntersectorBackend GetBackend() const { return backend_; }
+
+    // Colliding pairs of the last Intersect (or contacts of the last IntersectSwept)
+    const std::vector<CollisionPair>& GetCollisions() const { return collisions_; }
+
+    // Penetration depths (EPA) of the collisions of the last Intersect in the same order, filled only if they were requested
+    const std::vector<float>& GetPenetrationDepths() const { return penetration_depths_; }
+
+    /*
+        Meshes of the model (obstacle handle or car model in the AddCarParts order) hit by the last Intersect,
+        every mesh is listed once. Lists are reused, so nothing is allocated and they are valid until the next Intersect
+    */
+    const std::vector<int>& GetIntersectedObstacleMeshIndices(const int model_index) const;
+    const std::vector<int>& GetIntersectedCarPartMeshIndices(const int model_index) const;
 
 private:
-    // std::pair<int, int> ObstacleIndexToModelNameMeshIndex(const int obstacle_index) const {
-    //     return obstacle_index_to_model_index_mesh_index.at(obstacle_index);
-    // }
+    // Compute shader, every car part is tested with every obstacle, only colliding pairs are read back
+    void IntersectGPU();
+
+    // World space bounds of every car part are checked only with obstacles found by the BVH
+    void IntersectCPU();
+    void UpdateObstacleBvh();
+
+    // Sweep and prune keeps the cars overlapping obstacles on the ground plane between the calls
+    void IntersectSweep();
+
+    // World bounds of the car parts, their collision groups and the whole cars
+    void UpdateCarBounds();
 
-    // std::pair<int, int> CarPartIndexToModelNameMeshIndex(const int car_part_index) const {
-    //     return car_part_index_to_model_index_mesh_index.at(car_part_index);
-    // }
+    // Pairs of the obstacle with the parts of the car, only the groups overlapping the obstacle are descended into
+    void CollectCarCollisions(const int car_index, const int obstacle_index);
 
-    std::map<int, std::pair<int, int>> obstacle_index_to_model_index_mesh_index{};
-    std::map<int, std::pair<int, int>> car_part_index_to_model_index_mesh_index{};
-    int current_obstacle_index_ = 0;
-    int current_car_part_index_ = 0;
+    // Keeps only the candidate pairs whose oriented boxes overlap, pairs of axis-aligned boxes are already exact
+    void FilterOrientedPairs();
+
+    // Keeps only the pairs whose convex hulls intersect, starting GJK from the directions of the previous call
+    void FilterConvexHullPairs();
+
+    // Fills the lists of hit meshes from the collisions, only the lists filled by the previous call are cleared
+    void UpdateHitLists();
 
-    std::vector<MemoryAlignedBBox> obstacle_bboxes_;
     std::vector<MemoryAlignedBBox> car_parts_bboxes_;
 
-    const std::string intersect_shader_name_;
+    // Car parts of the i-th added car model are [car_part_offsets_[i], car_part_offsets_[i + 1])
+    std::vector<int> car_part_offsets_{0};
+
+    /*
+        Collision hierarchy: whole car -> CarCollisionGroup -> parts. Groups of the i-th car are
+        [i * groups count, (i + 1) * groups count), parts of the group g are car_group_parts_[car_group_offsets_[g], car_group_offsets_[g + 1])
+    */
+    std::vector<int> car_group_offsets_{0};
+    std::vector<int> car_group_parts_;
+    ObstacleBounds cars_bounds_;
+    ObstacleBounds car_groups_bounds_;
+
+    // Structures below are rebuilt when their version differs from the registry one
+    std::shared_ptr<ObstacleRegistry> obstacle_registry_;
+    Bvh obstacle_bvh_;
+    size_t obstacle_bvh_version_ = 0;
+
+    // Sorted endpoints of obstacles and whole cars survive between the calls
+    SweepAndPrune obstacle_sweep_;
+    ObstacleBounds car_parts_bounds_;
+    ObstacleBounds swept_start_bounds_;
+    ObstacleBounds swept_end_bounds_;
+
+    bool continuous_ = false;
+
+    bool oriented_narrowphase_ = false;
+    BoxNarrowphase box_narrowphase_;
+    OrientedBoxes car_parts_oriented_boxes_;
+    std::vector<int> narrowphase_pair_indices_;
+    std::vector<std::uint8_t> narrowphase_overlaps_;
+
+    // Obstacle index in the high half of the key, car part index in the low one
+    struct ConvexHullDirection {
+        std::uint64_t key;
+        GL::Vec3 direction;
+    };
+
+    bool convex_hull_narrowphase_ = false;
+    bool penetration_depths_enabled_ = false;
+    std::vector<ConvexHullInstance> car_parts_convex_hulls_;
+    // Directions of the pairs checked by the last call sorted by the key, looked up by binary search
+    std::vector<ConvexHullDirection> convex_hull_directions_;
+    std::vector<ConvexHullDirection> previous_convex_hull_directions_;
+    PenetrationBuffers penetration_buffers_;
+
+    // GPU backend buffers live as long as the intersector
+    PersistentStorageBuffer obstacle_ssbo_;
+    PersistentStorageBuffer car_parts_ssbo_;
+    PersistentStorageBuffer intersection_result_ssbo_;
+    size_t obstacle_ssbo_version_ = 0;
+    std::vector<WorldBBox> car_parts_world_bboxes_; // staging of the car parts upload
 
-    std::pair<std::vector<int>, std::vector<int>> results_;
+    const std::string intersect_shader_name_;
+    const IntersectorBackend backend_;
+
+    // Results are kept in flat arrays reused between the calls
+    std::vector<CollisionPair> collisions_;
+    std::vector<float> penetration_depths_;
+    std::vector<int> query_obstacle_ids_;
+    std::vector<std::uint8_t> obstacle_hit_flags_; // per box, set only inside UpdateHitLists
+    std::vector<std::uint8_t> car_part_hit_flags_; // per car part, same
+    std::vector<std::vector<int>> obstacle_hit_meshes_; // per obstacle handle
+    std::vector<std::vector<int>> car_part_hit_meshes_; // per car model
+    std::vector<int> hit_obstacle_handles_;
+    std::vector<int> hit_car_models_;
 
     friend class Gui; // access to private variables
 };
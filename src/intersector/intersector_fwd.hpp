@@ -2,6 +2,9 @@
 
 namespace App {
 
+struct CollisionResultsHeader;
+struct CollisionPair;
+
 class CollisionIntersector;
 
 } // namespace App
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "lidar.hpp"
+
+namespace App {
+
+// Extern variables
+extern const size_t APP_LIDAR_MIN_PACKETS_PER_THREAD;
+
+// Beams are padded to the widest SIMD width, so every packet is full
+constexpr int APP_LIDAR_MAX_PACKET_SIZE = 16;
+
+Lidar::Lidar(const int channels_count, const int horizontal_resolution, const float min_elevation, const float max_elevation,
+    const float range, const float update_rate, const GL::Vec3& position)
+    : channels_count_(channels_count), horizontal_resolution_(horizontal_resolution), range_(range),
+    scan_period_((update_rate > 0.0f) ? 1.0f / update_rate : 0.0f), position_(position), time_since_scan_(0.0f),
+    obstacle_registry_(std::make_shared<ObstacleRegistry>()) {
+    if ((channels_count_ <= 0) || (horizontal_resolution_ <= 0)) {
+        throw std::runtime_error("Lidar: channels count and horizontal resolution have to be positive");
+    }
+    if (!(range_ > 0.0f)) {
+        throw std::runtime_error("Lidar: range has to be positive");
+    }
+    if (max_elevation < min_elevation) {
+        throw std::runtime_error("Lidar: max elevation is less than min elevation");
+    }
+
+    const int beams_count = GetBeamsCount();
+    const int padded_beams_count = (beams_count + APP_LIDAR_MAX_PACKET_SIZE - 1) / APP_LIDAR_MAX_PACKET_SIZE * APP_LIDAR_MAX_PACKET_SIZE;
+    beam_direction_x_.resize(padded_beams_count);
+    beam_direction_y_.resize(padded_beams_count);
+    beam_direction_z_.resize(padded_beams_count);
+
+    const float degrees_to_radians = static_cast<float>(APP_MATH_PI / 180.0);
+    const float elevation_step = (channels_count_ > 1) ? (max_elevation - min_elevation) / (channels_count_ - 1) : 0.0f;
+    const float azimuth_step = static_cast<float>(2.0 * APP_MATH_PI) / horizontal_resolution_;
+
+    for (int beam_index = 0; beam_index < padded_beams_count; ++beam_index) {
+        // Padding beams repeat the last one, their results are dropped
+        const int source_index = (std::min)(beam_index, beams_count - 1);
+        const float elevation = (min_elevation + elevation_step * (source_index / horizontal_resolution_)) * degrees_to_radians;
+        const float azimuth = azimuth_step * (source_index % horizontal_resolution_);
+
+        // Forward is +Z in car space, as the middle ray of the RayIntersector fan
+        beam_direction_x_[beam_index] = std::cos(elevation) * std::sin(azimuth);
+        beam_direction_y_[beam_index] = std::sin(elevation);
+        beam_direction_z_[beam_index] = std::cos(elevation) * std::cos(azimuth);
+    }
+
+    world_direction_x_.resize(padded_beams_count);
+    world_direction_y_.resize(padded_beams_count);
+    world_direction_z_.resize(padded_beams_count);
+    padded_distances_.resize(padded_beams_count);
+
+    distances_.assign(beams_count, std::numeric_limits<float>::infinity());
+    points_.reserve(beams_count);
+}
+
+Lidar::Lidar(const Config::LidarConfig& config)
+    : Lidar(config.channels_count, config.horizontal_resolution, config.min_elevation, config.max_elevation,
+        config.range, config.update_rate, config.position) {}
+
+void Lidar::SetObstacleRegistry(std::shared_ptr<ObstacleRegistry> obstacle_registry) {
+    obstacle_registry_ = std::move(obstacle_registry);
+    obstacle_bvh_version_ = 0;
+}
+
+bool Lidar::Update(const GL::Mat4& car_model_matrix, const float delta_time) {
+    time_since_scan_ += delta_time;
+    if (time_since_scan_ < scan_period_) {
+        return false;
+    }
+    // WARNING: skipped periods are not caught up, the sensor can't scan faster than the simulation steps
+    time_since_scan_ = (scan_period_ > 0.0f) ? std::fmod(time_since_scan_, scan_period_) : 0.0f;
+
+    Scan(car_model_matrix);
+    return true;
+}
+
+void Lidar::Scan(const GL::Mat4& car_model_matrix) {
+    using namespace Simd;
+
+    obstacle_registry_->Update();
+    if (obstacle_bvh_version_ != obstacle_registry_->GetVersion()) {
+        obstacle_bvh_.Build(obstacle_registry_->GetBounds());
+        obstacle_bvh_version_ = obstacle_registry_->GetVersion();
+    }
+
+    const GL::Vec3 origin = car_model_matrix * position_;
+    const int beams_count = GetBeamsCount();
+    const int padded_beams_count = static_cast<int>(padded_distances_.size());
+    const size_t packets_count = padded_beams_count / APP_LIDAR_MAX_PACKET_SIZE;
+
+    // Rotation part of the column-major model matrix
+    const float* m = car_model_matrix.m;
+    const Float m0 = Broadcast(m[0]), m1 = Broadcast(m[1]), m2 = Broadcast(m[2]);
+    const Float m4 = Broadcast(m[4]), m5 = Broadcast(m[5]), m6 = Broadcast(m[6]);
+    const Float m8 = Broadcast(m[8]), m9 = Broadcast(m[9]), m10 = Broadcast(m[10]);
+
+    // Every thread rotates and traces its own range of packets, the BVH is only read
+    ParallelFor(packets_count, APP_LIDAR_MIN_PACKETS_PER_THREAD, [&](const size_t begin, const size_t end) {
+        const int first_beam = static_cast<int>(begin) * APP_LIDAR_MAX_PACKET_SIZE;
+        const int last_beam = static_cast<int>(end) * APP_LIDAR_MAX_PACKET_SIZE;
+
+        for (int beam = first_beam; beam < last_beam; beam += APP_SIMD_WIDTH) {
+            const Float x = Load(beam_direction_x_.data() + beam);
+            const Float y = Load(beam_direction_y_.data() + beam);
+            const Float z = Load(beam_direction_z_.data() + beam);
+
+            // Car transform may be scaled, so directions are normalized again
+            Float world_x = m0 * x + m4 * y + m8 * z;
+            Float world_y = m1 * x + m5 * y + m9 * z;
+            Float world_z = m2 * x + m6 * y + m10 * z;
+            Float inverse_length = Broadcast(1.0f) / Sqrt(world_x * world_x + world_y * world_y + world_z * world_z);
+
+            Store(world_direction_x_.data() + beam, world_x * inverse_length);
+            Store(world_direction_y_.data() + beam, world_y * inverse_length);
+            Store(world_direction_z_.data() + beam, world_z * inverse_length);
+        }
+
+        obstacle_bvh_.IntersectRays(origin, world_direction_x_.data() + first_beam, world_direction_y_.data() + first_beam,
+            world_direction_z_.data() + first_beam, padded_distances_.data() + first_beam, last_beam - first_beam, range_);
+    });
+
+    std::copy(padded_distances_.begin(), padded_distances_.begin() + beams_count, distances_.begin());
+
+    points_.clear();
+    for (int beam_index = 0; beam_index < beams_count; ++beam_index) {
+        const float distance = distances_[beam_index];
+        if (std::isinf(distance)) {
+            continue;
+        }
+        points_.push_back(LidarPoint{
+            origin.X + world_direction_x_[beam_index] * distance,
+            origin.Y + world_direction_y_[beam_index] * distance,
+            origin.Z + world_direction_z_[beam_index] * distance,
+            static_cast<std::uint32_t>(beam_index)
+        });
+    }
+}
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+// STL
+#define NOMINMAX
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// OpenGL Wrapper
+#include <GL/OOGL.hpp>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <lidar/lidar_fwd.hpp>
+
+// LibSmartCar
+#include <helpers/helpers.hpp>
+#include <config/config_handler.hpp>
+#include <bvh/bvh.hpp>
+#include <obstacle_registry/obstacle_registry.hpp>
+#include <simd/simd.hpp>
+
+namespace App {
+
+// World space point of a beam return, 16 bytes so the cloud may be uploaded as is
+struct LidarPoint {
+    float x;
+    float y;
+    float z;
+    std::uint32_t beam_index;
+};
+static_assert(sizeof(LidarPoint) == 16);
+
+/*
+    Multi-layer scanning sensor: channels are spread evenly over the elevation range,
+    every channel makes a full turn with horizontal_resolution beams (the first one looks forward).
+    Beam index is channel * horizontal_resolution + azimuth index, so neighbouring beams
+    form coherent packets for the obstacles BVH traversal
+*/
+class Lidar {
+public:
+    Lidar(const int channels_count, const int horizontal_resolution, const float min_elevation, const float max_elevation,
+        const float range, const float update_rate, const GL::Vec3& position);
+    Lidar(const Config::LidarConfig& config);
+
+    // Obstacles are kept in the registry, which may be shared with other sensors of the world
+    void SetObstacleRegistry(std::shared_ptr<ObstacleRegistry> obstacle_registry);
+    std::shared_ptr<ObstacleRegistry> GetObstacleRegistry() const { return obstacle_registry_; }
+
+    // Scans once 1 / update_rate seconds passed since the previous scan, returns true if a new scan was made
+    bool Update(const GL::Mat4& car_model_matrix, const float delta_time);
+
+    // Full sweep right away
+    void Scan(const GL::Mat4& car_model_matrix);
+
+    int GetChannelsCount() const { return channels_count_; }
+    int GetHorizontalResolution() const { return horizontal_resolution_; }
+    int GetBeamsCount() const { return channels_count_ * horizontal_resolution_; }
+
+    // Distance of every beam, infinity if nothing is hit within the range
+    const std::vector<float>& GetDistances() const { return distances_; }
+
+    // Returns only, in the beams order
+    const std::vector<LidarPoint>& GetPoints() const { return points_; }
+
+private:
+    const int channels_count_;
+    const int horizontal_resolution_;
+    const float range_;
+    const float scan_period_;
+    const GL::Vec3 position_; // car space
+
+    float time_since_scan_;
+
+    // Beam directions in car space, padded to the widest SIMD width
+    std::vector<float> beam_direction_x_;
+    std::vector<float> beam_direction_y_;
+    std::vector<float> beam_direction_z_;
+
+    // World space directions of the current scan and its raw results
+    std::vector<float> world_direction_x_;
+    std::vector<float> world_direction_y_;
+    std::vector<float> world_direction_z_;
+    std::vector<float> padded_distances_;
+
+    std::shared_ptr<ObstacleRegistry> obstacle_registry_;
+    Bvh obstacle_bvh_;
+    size_t obstacle_bvh_version_ = 0;
+
+    std::vector<float> distances_;
+    std::vector<LidarPoint> points_;
+
+    friend class Gui; // access to private variables
+};
+
+} // namespace App
\ No newline at end of file
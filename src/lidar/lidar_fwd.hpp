@@ -0,0 +1,8 @@
+#pragma once
+
+namespace App {
+
+struct LidarPoint;
+class Lidar;
+
+} // namespace App
\ No newline at end of file
@@ -10,9 +10,22 @@ extern const AssimpMaterialFloatParameters APP_ASSIMP_METALLIC_FACTOR_PARAMETERS
 extern const AssimpMaterialFloatParameters APP_ASSIMP_ROUGHNESS_FACTOR_PARAMETERS;
 extern const AssimpMaterialTextureParameters APP_ASSIMP_NORMAL_TEXTURE_PARAMETERS;
 
+std::map<std::string, std::weak_ptr<const TriangleBvh>> AssimpLoader::meshes_to_loaded_triangle_bvhs_;
+std::map<std::string, std::weak_ptr<const ConvexHull>> AssimpLoader::meshes_to_loaded_convex_hulls_;
+
+// Entries of the destroyed models are dropped, so the cache doesn't grow with every reload
+template <typename T>
+static void EraseExpired(std::map<std::string, std::weak_ptr<T>>& cache) {
+    for (auto entry = cache.begin(); entry != cache.end();) {
+        entry = entry->second.expired() ? cache.erase(entry) : std::next(entry);
+    }
+}
+
 AssimpLoader::AssimpLoader(std::string default_shader_name, std::string bbox_shader_name, std::string& path)
-    : default_shader_name_(default_shader_name), bbox_shader_name_(bbox_shader_name) {
+    : default_shader_name_(default_shader_name), bbox_shader_name_(bbox_shader_name), path_(path) {
     directory_ = GetFolderFromPath(path);
+    EraseExpired(meshes_to_loaded_triangle_bvhs_);
+    EraseExpired(meshes_to_loaded_convex_hulls_);
 
     Assimp::Importer importer;
     // aiProcess_FlipUVs flips the texture coordinates on the y-axis <- necessary for OpenGL
@@ -189,8 +202,22 @@ void AssimpLoader::HandleMesh(aiMesh* mesh, const aiScene* scene, aiMatrix4x4 tr
         material = HandleMaterial(assimp_material);
     }
 
+    // Triangle BVH and convex hull are built once per mesh of the file
+    size_t mesh_index = std::find(scene->mMeshes, scene->mMeshes + scene->mNumMeshes, mesh) - scene->mMeshes;
+    std::string mesh_key = path_ + "#" + std::to_string(mesh_index);
+    std::shared_ptr<const TriangleBvh> triangle_bvh = meshes_to_loaded_triangle_bvhs_[mesh_key].lock();
+    if (!triangle_bvh) {
+        triangle_bvh = std::make_shared<const TriangleBvh>(vertices, indices);
+        meshes_to_loaded_triangle_bvhs_[mesh_key] = triangle_bvh;
+    }
+    std::shared_ptr<const ConvexHull> convex_hull = meshes_to_loaded_convex_hulls_[mesh_key].lock();
+    if (!convex_hull) {
+        convex_hull = std::make_shared<const ConvexHull>(vertices);
+        meshes_to_loaded_convex_hulls_[mesh_key] = convex_hull;
+    }
+
     BBox bbox{bbox_shader_name_, bbox_min, bbox_max};
-    Mesh new_mesh{default_shader_name_, bbox_shader_name_, mesh->mName.C_Str(), Transform{transform_to_model}, vertices, indices, material, bbox};
+    Mesh new_mesh{default_shader_name_, bbox_shader_name_, mesh->mName.C_Str(), Transform{transform_to_model}, vertices, indices, material, bbox, triangle_bvh, convex_hull};
     meshes_.push_back(new_mesh);
 }
 
@@ -2,6 +2,7 @@
 
 // STL
 #include <map>
+#include <memory>
 #include <exception>
 #include <algorithm>
 
@@ -22,6 +23,8 @@
 #include <mesh/mesh.hpp>
 #include <texture/texture.hpp>
 #include <material/material.hpp>
+#include <triangle_bvh/triangle_bvh.hpp>
+#include <convex_hull/convex_hull.hpp>
 
 namespace App {
 
@@ -41,8 +44,16 @@ private:
 
     std::vector<Mesh> meshes_;
     std::map<std::string, Texture> paths_to_loaded_textures_;
+    std::string path_;
     std::string directory_;
 
+    /*
+        Triangles don't depend on the node transformation, so they are shared by every model loaded from the same file.
+        Meshes own the structures, the caches only refer to them and forget them after the last model is destroyed
+    */
+    static std::map<std::string, std::weak_ptr<const TriangleBvh>> meshes_to_loaded_triangle_bvhs_;
+    static std::map<std::string, std::weak_ptr<const ConvexHull>> meshes_to_loaded_convex_hulls_;
+
     std::string default_shader_name_;
     std::string bbox_shader_name_;
 };
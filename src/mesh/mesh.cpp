@@ -13,8 +13,10 @@ extern const int APP_GL_VEC2_BYTESIZE;
 extern const int APP_GL_VEC3_COMPONENTS_COUNT;
 extern const int APP_GL_VEC3_BYTESIZE;
 
-Mesh::Mesh(std::string default_shader_name, std::string bbox_shader_name, std::string name, Transform transform_to_model, std::vector<GL::Vertex> vertices, std::vector<int> indices, Material material, BBox bbox)
+Mesh::Mesh(std::string default_shader_name, std::string bbox_shader_name, std::string name, Transform transform_to_model, std::vector<GL::Vertex> vertices, std::vector<int> indices, Material material, BBox bbox,
+    std::shared_ptr<const TriangleBvh> triangle_bvh, std::shared_ptr<const ConvexHull> convex_hull)
     : default_shader_name_(default_shader_name), bbox_shader_name_(bbox_shader_name), name_(name), transform_to_model_(transform_to_model), vertices_(vertices), indices_(indices), material_(material), bbox_(bbox),
+    triangle_bvh_(std::move(triangle_bvh)), convex_hull_(std::move(convex_hull)),
     is_instanced_(false) {
     vbo_ = GL::VertexBuffer(vertices.data(), vertices.size() * APP_GL_VERTEX_BYTESIZE, GL::BufferUsage::StaticDraw);
     ebo_ = GL::VertexBuffer(indices.data(), indices.size() * sizeof(unsigned int), GL::BufferUsage::StaticDraw);
@@ -65,12 +67,24 @@ void Mesh::Draw() const {
     }
 }
 
+GL::Mat4 Mesh::GetMeshToModel() const {
+    return static_cast<GL::Mat4>(transform_to_model_) * static_cast<GL::Mat4>(self_transform_);
+}
+
 MemoryAlignedBBox Mesh::GetMABB() const {
     auto mabb = bbox_.GetMABB();
-    mabb.mesh_to_model = static_cast<GL::Mat4>(transform_to_model_);
+    mabb.mesh_to_model = GetMeshToModel();
     return mabb;
 }
 
+TriangleBvhInstance Mesh::GetTriangleBvhInstance() const {
+    return TriangleBvhInstance{triangle_bvh_, GetMeshToModel()};
+}
+
+ConvexHullInstance Mesh::GetConvexHullInstance() const {
+    return ConvexHullInstance{convex_hull_, GetMeshToModel()};
+}
+
 void Mesh::DrawBBoxOnCollision() const {
     auto& context = App::Context::Get();
     auto& gl = context.gl->get();
@@ -2,6 +2,7 @@
 
 // STL
 #include <iostream>
+#include <memory>
 #include <vector>
 
 // OpenGL Wrapper
@@ -18,22 +19,32 @@
 #include <texture/texture.hpp>
 #include <bbox/bbox.hpp>
 #include <material/material.hpp>
+#include <triangle_bvh/triangle_bvh.hpp>
+#include <convex_hull/convex_hull.hpp>
 
 namespace App {
 
 class Mesh {
 public:
     Mesh(std::string default_shader_name, std::string bbox_shader_name, std::string name, Transform transform_to_model,
-        std::vector<GL::Vertex> vertices, std::vector<int> indices, Material material, BBox bbox);
+        std::vector<GL::Vertex> vertices, std::vector<int> indices, Material material, BBox bbox,
+        std::shared_ptr<const TriangleBvh> triangle_bvh, std::shared_ptr<const ConvexHull> convex_hull);
 
     void SetDrawBBox(bool value);
     void Draw() const;
     MemoryAlignedBBox GetMABB() const;
     void DrawBBoxOnCollision() const;
 
+    // Placed into the model space, the model matrix is applied by the caller
+    TriangleBvhInstance GetTriangleBvhInstance() const;
+    ConvexHullInstance GetConvexHullInstance() const;
+
     void MakeInstanced(const std::vector<Transform>& instance_transforms);
 
 private:
+    // Self transform followed by the transform to the model, same as in the shaders
+    GL::Mat4 GetMeshToModel() const;
+
     bool is_instanced_;
     std::optional<std::vector<Transform>> instance_transforms_;
     GL::VertexBuffer instance_transforms_vbo_;  // vertex buffer object
@@ -43,6 +54,8 @@ private:
     Transform self_transform_;
 
     BBox bbox_;
+    std::shared_ptr<const TriangleBvh> triangle_bvh_;
+    std::shared_ptr<const ConvexHull> convex_hull_;
 
     std::vector<GL::Vertex> vertices_;
     std::vector<int> indices_;
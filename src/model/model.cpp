@@ -19,26 +19,32 @@ Model::Model(Config::CommonModelConfig config)
 
 void Model::SetScale(GL::Vec3 scale) {
     transform_.SetScale(scale);
+    ++transform_version_;
 }
 
 void Model::UpdateScale(GL::Vec3 additional_scale) {
     transform_.UpdateScale(additional_scale);
+    ++transform_version_;
 }
 
 void Model::SetRotation(float rotate_degrees, GL::Vec3 rotate_axis) {
     transform_.SetRotation(rotate_degrees, rotate_axis);
+    ++transform_version_;
 }
 
 void Model::UpdateRotation(float additional_rotate_degrees, GL::Vec3 additional_rotate_axis) {
     transform_.UpdateRotation(additional_rotate_degrees, additional_rotate_axis);
+    ++transform_version_;
 }
 
 void Model::SetTranslation(GL::Vec3 translation) {
     transform_.SetTranslation(translation);
+    ++transform_version_;
 }
 
 void Model::UpdateTranslation(GL::Vec3 additional_translation) {
     transform_.UpdateTranslation(additional_translation);
+    ++transform_version_;
 }
 
 const GL::Mat4 Model::GetModelMatrix() const {
@@ -87,6 +93,30 @@ std::vector<MemoryAlignedBBox> Model::CollectMABB() const {
     return result;
 }
 
+std::vector<TriangleBvhInstance> Model::CollectTriangleBvhs() const {
+    std::vector<TriangleBvhInstance> result;
+    result.reserve(meshes_.size());
+
+    for (auto&& mesh : meshes_) {
+        auto instance = mesh.GetTriangleBvhInstance();
+        instance.mesh_to_world = GetModelMatrix() * instance.mesh_to_world;
+        result.push_back(instance);
+    }
+    return result;
+}
+
+std::vector<ConvexHullInstance> Model::CollectConvexHulls() const {
+    std::vector<ConvexHullInstance> result;
+    result.reserve(meshes_.size());
+
+    for (auto&& mesh : meshes_) {
+        auto instance = mesh.GetConvexHullInstance();
+        instance.mesh_to_world = GetModelMatrix() * instance.mesh_to_world;
+        result.push_back(instance);
+    }
+    return result;
+}
+
 void Model::DrawBBoxOnCollision(size_t bbox_mesh_index) const {
     auto& context = App::Context::Get();
     auto& gl = context.gl->get();
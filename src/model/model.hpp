@@ -16,6 +16,8 @@
 #include <config/config_handler.hpp>
 #include <loader/loader.hpp>
 #include <timer/timer.hpp>
+#include <triangle_bvh/triangle_bvh.hpp>
+#include <convex_hull/convex_hull.hpp>
 
 namespace App {
 
@@ -40,15 +42,22 @@ public:
 
     virtual const GL::Mat4 GetModelMatrix() const;
 
+    // Changes with every transform update, so the obstacle registry recomputes bounds only for moved models
+    size_t GetTransformVersion() const { return transform_version_; }
+
     void SetDrawBBoxes(bool value);
     virtual void Draw() const;
     virtual std::vector<MemoryAlignedBBox> CollectMABB() const;
+    // Same order as CollectMABB
+    virtual std::vector<TriangleBvhInstance> CollectTriangleBvhs() const;
+    virtual std::vector<ConvexHullInstance> CollectConvexHulls() const;
     virtual void DrawBBoxOnCollision(size_t bbox_mesh_index) const;
 
 protected:
     std::string name_;
     std::vector<Mesh> meshes_;
     Transform transform_;
+    size_t transform_version_ = 0;
 
     std::string default_shader_name_;
     std::string bbox_shader_name_;
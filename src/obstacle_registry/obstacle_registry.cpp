@@ -0,0 +1,147 @@
+#include "obstacle_registry.hpp"
+
+namespace App {
+
+// Extern variables
+/* empty */
+
+ObstacleHandle ObstacleRegistry::Add(const Model* model) {
+    ++version_;
+
+    // Handles of removed models are reused, so entries don't grow while models come and go
+    ObstacleHandle handle = static_cast<ObstacleHandle>(entries_.size());
+    if (!free_handles_.empty()) {
+        handle = free_handles_.back();
+        free_handles_.pop_back();
+    } else {
+        entries_.emplace_back();
+    }
+    const size_t boxes_count = model->CollectMABB().size();
+    entries_[handle] = Entry{model, model->GetTransformVersion(), GetBoxesCount(), boxes_count};
+
+    // Placeholders are filled right away
+    for (size_t mesh_index = 0; mesh_index < boxes_count; ++mesh_index) {
+        bounds_.Add(GL::Vec3{}, GL::Vec3{});
+        world_bboxes_.emplace_back();
+        oriented_boxes_.Add(OrientedBox{});
+        triangles_.emplace_back();
+        convex_hulls_.emplace_back();
+        box_owners_.emplace_back(handle, static_cast<int>(mesh_index));
+        box_versions_.push_back(version_);
+    }
+    UpdateEntry(entries_[handle]);
+    return handle;
+}
+
+void ObstacleRegistry::Remove(const ObstacleHandle handle) {
+    if ((handle < 0) || (handle >= static_cast<ObstacleHandle>(entries_.size())) || !entries_[handle].model) {
+        throw std::runtime_error("ObstacleRegistry: Remove of unknown handle " + std::to_string(handle));
+    }
+    ++version_;
+
+    Entry& removed_entry = entries_[handle];
+    const size_t first_box = removed_entry.first_box;
+    const size_t boxes_count = removed_entry.boxes_count;
+    removed_entry = Entry{nullptr, 0, 0, 0};
+    free_handles_.push_back(handle);
+
+    bounds_.Erase(first_box, boxes_count);
+    world_bboxes_.erase(world_bboxes_.begin() + first_box, world_bboxes_.begin() + first_box + boxes_count);
+    oriented_boxes_.Erase(first_box, boxes_count);
+    triangles_.erase(triangles_.begin() + first_box, triangles_.begin() + first_box + boxes_count);
+    convex_hulls_.erase(convex_hulls_.begin() + first_box, convex_hulls_.begin() + first_box + boxes_count);
+    box_owners_.erase(box_owners_.begin() + first_box, box_owners_.begin() + first_box + boxes_count);
+    box_versions_.erase(box_versions_.begin() + first_box, box_versions_.begin() + first_box + boxes_count);
+
+    // Boxes of the later models are shifted, so they are changed as well
+    for (auto&& entry : entries_) {
+        if (entry.first_box > first_box) {
+            entry.first_box -= boxes_count;
+        }
+    }
+    std::fill(box_versions_.begin() + first_box, box_versions_.end(), version_);
+}
+
+void ObstacleRegistry::Clear() {
+    ++version_;
+
+    entries_.clear();
+    free_handles_.clear();
+    bounds_.Clear();
+    world_bboxes_.clear();
+    oriented_boxes_.Clear();
+    triangles_.clear();
+    convex_hulls_.clear();
+    box_owners_.clear();
+    box_versions_.clear();
+}
+
+void ObstacleRegistry::Update() {
+    bool is_changed = false;
+    for (auto&& entry : entries_) {
+        if (!entry.model || (entry.transform_version == entry.model->GetTransformVersion())) {
+            continue;
+        }
+        if (!is_changed) {
+            ++version_;
+            is_changed = true;
+        }
+        entry.transform_version = entry.model->GetTransformVersion();
+        UpdateEntry(entry);
+    }
+}
+
+void ObstacleRegistry::UpdateEntry(Entry& entry) {
+    std::vector<MemoryAlignedBBox> bboxes = entry.model->CollectMABB();
+    std::vector<TriangleBvhInstance> triangle_bvhs = entry.model->CollectTriangleBvhs();
+    std::vector<ConvexHullInstance> convex_hulls = entry.model->CollectConvexHulls();
+
+    for (size_t mesh_index = 0; mesh_index < entry.boxes_count; ++mesh_index) {
+        const size_t box_index = entry.first_box + mesh_index;
+
+        GL::Vec3 min_point{};
+        GL::Vec3 max_point{};
+        GetWorldBounds(bboxes[mesh_index], min_point, max_point);
+
+        bounds_.Set(box_index, min_point, max_point);
+        world_bboxes_[box_index] = WorldBBox{
+            GL::Vec4{min_point.X, min_point.Y, min_point.Z, 1.0f},
+            GL::Vec4{max_point.X, max_point.Y, max_point.Z, 1.0f}
+        };
+        oriented_boxes_.Set(box_index, GetOrientedBox(bboxes[mesh_index]));
+        triangles_[box_index] = ObstacleTriangles{triangle_bvhs[mesh_index].bvh, GetAffineInverse(triangle_bvhs[mesh_index].mesh_to_world)};
+        convex_hulls_[box_index] = convex_hulls[mesh_index];
+        box_versions_[box_index] = version_;
+    }
+}
+
+void ObstacleRegistry::WriteWorldBBoxes(PersistentStorageBuffer& ssbo, size_t& written_version) const {
+    if (written_version == version_) {
+        return;
+    }
+
+    const size_t boxes_count = GetBoxesCount();
+    if (ssbo.Reserve(boxes_count * sizeof(WorldBBox))) {
+        ssbo.Write(world_bboxes_.data(), boxes_count * sizeof(WorldBBox));
+        written_version = version_;
+        return;
+    }
+
+    // Only contiguous ranges of changed boxes are written
+    size_t box_index = 0;
+    while (box_index < boxes_count) {
+        if (box_versions_[box_index] <= written_version) {
+            ++box_index;
+            continue;
+        }
+        size_t range_end = box_index;
+        while ((range_end < boxes_count) && (box_versions_[range_end] > written_version)) {
+            ++range_end;
+        }
+        ssbo.Write(world_bboxes_.data() + box_index, (range_end - box_index) * sizeof(WorldBBox), box_index * sizeof(WorldBBox));
+        box_index = range_end;
+    }
+    written_version = version_;
+}
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// OpenGL Wrapper
+#include <GL/OOGL.hpp>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <obstacle_registry/obstacle_registry_fwd.hpp>
+
+// LibSmartCar
+#include <helpers/helpers.hpp>
+#include <bvh/bvh.hpp>
+#include <box_narrowphase/box_narrowphase.hpp>
+#include <triangle_bvh/triangle_bvh.hpp>
+#include <convex_hull/convex_hull.hpp>
+#include <persistent_storage_buffer/persistent_storage_buffer.hpp>
+
+namespace App {
+
+/*
+    Tightly packed for std430, same layout is used for the car parts of the collision shader.
+    WARNING: must match ObstacleBBox in the ray shader and WorldBBox in the collision shader
+*/
+struct WorldBBox {
+    GL::Vec4 min_point;
+    GL::Vec4 max_point;
+};
+static_assert(sizeof(WorldBBox) == 32);
+
+// Rays are moved into the mesh space instead of moving the triangles into the world
+struct ObstacleTriangles {
+    std::shared_ptr<const TriangleBvh> bvh;
+    GL::Mat4 world_to_mesh;
+};
+
+using ObstacleHandle = int;
+
+/*
+    Obstacle boxes shared by the intersectors and the lidar of a world.
+    World space bounds are computed only when a model is added or its transform changes,
+    every change bumps the version, so consumers rebuild their structures only after changes
+    and upload only the boxes changed since their last upload
+*/
+class ObstacleRegistry {
+public:
+    /*
+        Every mesh of the model becomes a box, handles stay valid until Remove or Clear.
+        Handles of removed models are given to the later added ones.
+        WARNING: the model has to outlive the registry or be removed from it
+    */
+    ObstacleHandle Add(const Model* model);
+    void Remove(const ObstacleHandle handle);
+    void Clear();
+
+    // Recomputes the bounds of the models moved since the last call, for static scenes it is one comparison per model
+    void Update();
+
+    // Never zero, so consumers may start from zero
+    size_t GetVersion() const { return version_; }
+
+    size_t GetBoxesCount() const { return world_bboxes_.size(); }
+    const ObstacleBounds& GetBounds() const { return bounds_; }
+    const std::vector<WorldBBox>& GetWorldBBoxes() const { return world_bboxes_; }
+    const OrientedBoxes& GetOrientedBoxes() const { return oriented_boxes_; }
+    const std::vector<ObstacleTriangles>& GetTriangles() const { return triangles_; }
+    const std::vector<ConvexHullInstance>& GetConvexHulls() const { return convex_hulls_; }
+
+    // Handle of the model and index of the mesh in it
+    std::pair<ObstacleHandle, int> GetBoxOwner(const size_t box_index) const { return box_owners_[box_index]; }
+
+    /*
+        Writes the boxes changed after written_version (all of them if the storage was recreated) and updates written_version.
+        WARNING: dispatches still reading the buffer have to be finished
+    */
+    void WriteWorldBBoxes(PersistentStorageBuffer& ssbo, size_t& written_version) const;
+
+private:
+    struct Entry {
+        const Model* model; // nullptr after Remove
+        size_t transform_version;
+        size_t first_box;
+        size_t boxes_count;
+    };
+
+    void UpdateEntry(Entry& entry);
+
+    std::vector<Entry> entries_;
+    std::vector<ObstacleHandle> free_handles_; // entries removed and not reused yet
+
+    // Boxes of every model are contiguous, in the order of Add calls
+    ObstacleBounds bounds_;
+    std::vector<WorldBBox> world_bboxes_;
+    OrientedBoxes oriented_boxes_;
+    std::vector<ObstacleTriangles> triangles_;
+    std::vector<ConvexHullInstance> convex_hulls_;
+    std::vector<std::pair<ObstacleHandle, int>> box_owners_;
+    std::vector<size_t> box_versions_; // version of the last change of every box
+
+    size_t version_ = 1;
+};
+
+} // namespace App
\ No newline at end of file
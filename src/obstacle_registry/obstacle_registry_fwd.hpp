@@ -0,0 +1,10 @@
+#pragma once
+
+namespace App {
+
+struct WorldBBox;
+struct ObstacleTriangles;
+
+class ObstacleRegistry;
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,327 @@
+#include "occupancy_grid.hpp"
+
+namespace App {
+
+// Extern variables
+extern const int APP_OCCUPANCY_GRID_MAX_CELLS_COUNT;
+
+/*
+    Squared distance transform of a sampled function (Felzenszwalb and Huttenlocher):
+    result[q] = min over p of (q - p)^2 + values[p], parabolas_* are scratch buffers of size count and count + 1
+*/
+static void DistanceTransform1D(const float* values, float* result, const int count, int* parabolas_positions, float* parabolas_bounds) {
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+
+    int parabolas_count = 0;
+    for (int position = 0; position < count; ++position) {
+        if (values[position] == infinity) {
+            continue;
+        }
+        while (true) {
+            if (parabolas_count == 0) {
+                parabolas_positions[0] = position;
+                parabolas_bounds[0] = -infinity;
+                parabolas_bounds[1] = infinity;
+                parabolas_count = 1;
+                break;
+            }
+
+            int last = parabolas_positions[parabolas_count - 1];
+            float intersection = ((values[position] + position * position) - (values[last] + last * last)) / (2.0f * (position - last));
+            if (intersection <= parabolas_bounds[parabolas_count - 1]) {
+                --parabolas_count;
+                continue;
+            }
+            parabolas_positions[parabolas_count] = position;
+            parabolas_bounds[parabolas_count] = intersection;
+            parabolas_bounds[parabolas_count + 1] = infinity;
+            ++parabolas_count;
+            break;
+        }
+    }
+
+    if (parabolas_count == 0) {
+        std::fill(result, result + count, infinity);
+        return;
+    }
+
+    int parabola_index = 0;
+    for (int position = 0; position < count; ++position) {
+        while (parabolas_bounds[parabola_index + 1] < position) {
+            ++parabola_index;
+        }
+        int offset = position - parabolas_positions[parabola_index];
+        result[position] = offset * offset + values[parabolas_positions[parabola_index]];
+    }
+}
+
+void OccupancyGrid::Clear() {
+    size_x_ = 0;
+    size_z_ = 0;
+    footprints_.clear();
+    cells_.clear();
+    distance_field_.clear();
+}
+
+void OccupancyGrid::Build(const ObstacleBounds& bounds, const float plane_height, const float cell_size, const bool build_distance_field) {
+    if (cell_size <= 0.0f) {
+        throw std::runtime_error("OccupancyGrid: cell size has to be positive");
+    }
+
+    Clear();
+    cell_size_ = cell_size;
+    plane_height_ = plane_height;
+
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    float max_x = -infinity;
+    float max_z = -infinity;
+    min_x_ = infinity;
+    min_z_ = infinity;
+
+    std::vector<size_t> crossed_indices{};
+    for (size_t index = 0; index < bounds.GetSize(); ++index) {
+        if ((plane_height < bounds.min_y[index]) || (bounds.max_y[index] < plane_height)) {
+            continue;
+        }
+        crossed_indices.push_back(index);
+        min_x_ = (std::min)(min_x_, bounds.min_x[index]);
+        min_z_ = (std::min)(min_z_, bounds.min_z[index]);
+        max_x = (std::max)(max_x, bounds.max_x[index]);
+        max_z = (std::max)(max_z, bounds.max_z[index]);
+    }
+    if (crossed_indices.empty()) {
+        return;
+    }
+
+    // One free cell around the obstacles, so rays entering the grid start in a free cell
+    min_x_ -= cell_size_;
+    min_z_ -= cell_size_;
+    size_x_ = static_cast<int>(std::ceil((max_x - min_x_) / cell_size_)) + 1;
+    size_z_ = static_cast<int>(std::ceil((max_z - min_z_) / cell_size_)) + 1;
+    if (static_cast<double>(size_x_) * size_z_ > APP_OCCUPANCY_GRID_MAX_CELLS_COUNT) {
+        throw std::runtime_error("OccupancyGrid: too many cells, increase the cell size");
+    }
+    cells_.assign(static_cast<size_t>(size_x_) * size_z_, 0);
+    footprints_.reserve(crossed_indices.size());
+
+    constexpr std::uint8_t max_count = std::numeric_limits<std::uint8_t>::max();
+    for (size_t index : crossed_indices) {
+        int first_x = static_cast<int>(std::floor((bounds.min_x[index] - min_x_) / cell_size_));
+        int first_z = static_cast<int>(std::floor((bounds.min_z[index] - min_z_) / cell_size_));
+        // Boxes ending exactly on the cell border don't occupy the next cell
+        int last_x = std::clamp(static_cast<int>(std::ceil((bounds.max_x[index] - min_x_) / cell_size_)) - 1, first_x, size_x_ - 1);
+        int last_z = std::clamp(static_cast<int>(std::ceil((bounds.max_z[index] - min_z_) / cell_size_)) - 1, first_z, size_z_ - 1);
+
+        footprints_.push_back(Footprint{bounds.min_x[index], bounds.min_z[index], bounds.max_x[index], bounds.max_z[index], first_x, first_z, last_x, last_z});
+        for (int cell_z = first_z; cell_z <= last_z; ++cell_z) {
+            for (int cell_x = first_x; cell_x <= last_x; ++cell_x) {
+                std::uint8_t& count = cells_[cell_z * size_x_ + cell_x];
+                count = (count < max_count) ? (count + 1) : max_count;
+            }
+        }
+    }
+
+    if (build_distance_field) {
+        ComputeDistanceField();
+    }
+}
+
+void OccupancyGrid::ComputeDistanceField() {
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+
+    const int max_size = (std::max)(size_x_, size_z_);
+    std::vector<float> values(max_size);
+    std::vector<float> result(max_size);
+    std::vector<int> parabolas_positions(max_size);
+    std::vector<float> parabolas_bounds(max_size + 1);
+
+    // Columns first, then rows of the column results give exact squared distances in cells
+    distance_field_.assign(cells_.size(), infinity);
+    for (int cell_x = 0; cell_x < size_x_; ++cell_x) {
+        for (int cell_z = 0; cell_z < size_z_; ++cell_z) {
+            values[cell_z] = IsOccupied(cell_x, cell_z) ? 0.0f : infinity;
+        }
+        DistanceTransform1D(values.data(), result.data(), size_z_, parabolas_positions.data(), parabolas_bounds.data());
+        for (int cell_z = 0; cell_z < size_z_; ++cell_z) {
+            distance_field_[cell_z * size_x_ + cell_x] = result[cell_z];
+        }
+    }
+
+    for (int cell_z = 0; cell_z < size_z_; ++cell_z) {
+        float* row = distance_field_.data() + cell_z * size_x_;
+        std::copy(row, row + size_x_, values.begin());
+        DistanceTransform1D(values.data(), result.data(), size_x_, parabolas_positions.data(), parabolas_bounds.data());
+        for (int cell_x = 0; cell_x < size_x_; ++cell_x) {
+            row[cell_x] = std::sqrt(result[cell_x]) * cell_size_;
+        }
+    }
+}
+
+void OccupancyGrid::IntersectRays(const GL::Vec3& origin, const GL::Vec3* directions, const int rays_count, float* result_distances) const {
+    std::vector<int> skipped_footprints{};
+    FindOriginFootprints(origin, skipped_footprints);
+    for (int ray_index = 0; ray_index < rays_count; ++ray_index) {
+        result_distances[ray_index] = IntersectRay(origin, directions[ray_index], skipped_footprints);
+    }
+}
+
+void OccupancyGrid::FindOriginFootprints(const GL::Vec3& origin, std::vector<int>& footprint_indices) const {
+    footprint_indices.clear();
+    if (IsEmpty()) {
+        return;
+    }
+
+    int cell_x = static_cast<int>(std::floor((origin.X - min_x_) / cell_size_));
+    int cell_z = static_cast<int>(std::floor((origin.Z - min_z_) / cell_size_));
+    if ((cell_x < 0) || (cell_x >= size_x_) || (cell_z < 0) || (cell_z >= size_z_) || !IsOccupied(cell_x, cell_z)) {
+        return;
+    }
+
+    for (int footprint_index = 0; footprint_index < static_cast<int>(footprints_.size()); ++footprint_index) {
+        const Footprint& footprint = footprints_[footprint_index];
+        if ((footprint.min_x <= origin.X) && (origin.X <= footprint.max_x) && (footprint.min_z <= origin.Z) && (origin.Z <= footprint.max_z)) {
+            footprint_indices.push_back(footprint_index);
+        }
+    }
+}
+
+bool OccupancyGrid::IsBlocked(const int cell_x, const int cell_z, const std::vector<int>& skipped_footprints) const {
+    const std::uint8_t count = cells_[cell_z * size_x_ + cell_x];
+    if (count == 0) {
+        return false;
+    }
+    // Saturated counts can't be compared, such cells always stop the rays
+    if (skipped_footprints.empty() || (count == std::numeric_limits<std::uint8_t>::max())) {
+        return true;
+    }
+
+    int skipped_count = 0;
+    for (int footprint_index : skipped_footprints) {
+        const Footprint& footprint = footprints_[footprint_index];
+        if ((footprint.first_x <= cell_x) && (cell_x <= footprint.last_x) && (footprint.first_z <= cell_z) && (cell_z <= footprint.last_z)) {
+            ++skipped_count;
+        }
+    }
+    return count > skipped_count;
+}
+
+float OccupancyGrid::IntersectRay(const GL::Vec3& origin, const GL::Vec3& direction, const std::vector<int>& skipped_footprints) const {
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    if (IsEmpty()) {
+        return infinity;
+    }
+
+    // Clip the ray with the grid rectangle
+    const float max_x = min_x_ + size_x_ * cell_size_;
+    const float max_z = min_z_ + size_z_ * cell_size_;
+    float t_enter = 0.0f;
+    float t_exit = infinity;
+
+    const float origin_coordinates[2] = {origin.X, origin.Z};
+    const float direction_coordinates[2] = {direction.X, direction.Z};
+    const float min_coordinates[2] = {min_x_, min_z_};
+    const float max_coordinates[2] = {max_x, max_z};
+    for (int axis = 0; axis < 2; ++axis) {
+        if (direction_coordinates[axis] == 0.0f) {
+            if ((origin_coordinates[axis] < min_coordinates[axis]) || (max_coordinates[axis] <= origin_coordinates[axis])) {
+                return infinity;
+            }
+            continue;
+        }
+        float t_min = (min_coordinates[axis] - origin_coordinates[axis]) / direction_coordinates[axis];
+        float t_max = (max_coordinates[axis] - origin_coordinates[axis]) / direction_coordinates[axis];
+        t_enter = (std::max)(t_enter, (std::min)(t_min, t_max));
+        t_exit = (std::min)(t_exit, (std::max)(t_min, t_max));
+    }
+    if (t_enter >= t_exit) {
+        return infinity;
+    }
+
+    const int step_x = (direction.X > 0.0f) ? 1 : -1;
+    const int step_z = (direction.Z > 0.0f) ? 1 : -1;
+    const float t_delta_x = (direction.X != 0.0f) ? (cell_size_ / std::fabs(direction.X)) : infinity;
+    const float t_delta_z = (direction.Z != 0.0f) ? (cell_size_ / std::fabs(direction.Z)) : infinity;
+    const float planar_speed = std::hypot(direction.X, direction.Z);
+
+    int cell_x = 0;
+    int cell_z = 0;
+    float t_next_x = infinity;
+    float t_next_z = infinity;
+
+    // DDA state at the point of the ray with parameter t
+    auto locate = [&](const float t) {
+        float x = origin.X + direction.X * t;
+        float z = origin.Z + direction.Z * t;
+        cell_x = std::clamp(static_cast<int>(std::floor((x - min_x_) / cell_size_)), 0, size_x_ - 1);
+        cell_z = std::clamp(static_cast<int>(std::floor((z - min_z_) / cell_size_)), 0, size_z_ - 1);
+
+        if (direction.X != 0.0f) {
+            float boundary_x = min_x_ + (cell_x + ((step_x > 0) ? 1 : 0)) * cell_size_;
+            t_next_x = (boundary_x - origin.X) / direction.X;
+        }
+        if (direction.Z != 0.0f) {
+            float boundary_z = min_z_ + (cell_z + ((step_z > 0) ? 1 : 0)) * cell_size_;
+            t_next_z = (boundary_z - origin.Z) / direction.Z;
+        }
+    };
+
+    float t = t_enter;
+    locate(t);
+
+    // Free cells closer than that to obstacles are traversed one by one
+    const float min_sphere_step = 2.0f * cell_size_;
+
+    while (true) {
+        if (IsBlocked(cell_x, cell_z, skipped_footprints)) {
+            return t;
+        }
+
+        if (HasDistanceField() && (planar_speed > 0.0f)) {
+            // Any point of the cell is at most half diagonal from its center, same for the occupied cell
+            float free_radius = distance_field_[cell_z * size_x_ + cell_x] - 2.0f * cell_size_;
+            if (free_radius == infinity) {
+                return infinity;
+            }
+            if (free_radius > min_sphere_step) {
+                t += free_radius / planar_speed;
+                if (t >= t_exit) {
+                    return infinity;
+                }
+                locate(t);
+                continue;
+            }
+        }
+
+        if (t_next_x < t_next_z) {
+            cell_x += step_x;
+            t = t_next_x;
+            t_next_x += t_delta_x;
+        } else {
+            cell_z += step_z;
+            t = t_next_z;
+            t_next_z += t_delta_z;
+        }
+        if ((cell_x < 0) || (cell_x >= size_x_) || (cell_z < 0) || (cell_z >= size_z_)) {
+            return infinity;
+        }
+    }
+}
+
+float OccupancyGrid::GetNearestObstacleDistance(const GL::Vec3& point) const {
+    if (!HasDistanceField()) {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    const float max_x = min_x_ + size_x_ * cell_size_;
+    const float max_z = min_z_ + size_z_ * cell_size_;
+    float clamped_x = std::clamp(point.X, min_x_, max_x);
+    float clamped_z = std::clamp(point.Z, min_z_, max_z);
+
+    int cell_x = std::clamp(static_cast<int>(std::floor((clamped_x - min_x_) / cell_size_)), 0, size_x_ - 1);
+    int cell_z = std::clamp(static_cast<int>(std::floor((clamped_z - min_z_) / cell_size_)), 0, size_z_ - 1);
+
+    // Points outside the grid are farther by their distance to the grid
+    return distance_field_[cell_z * size_x_ + cell_x] + std::hypot(point.X - clamped_x, point.Z - clamped_z);
+}
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+// STL
+#define NOMINMAX
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// OpenGL Wrapper
+#include <GL/OOGL.hpp>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <occupancy_grid/occupancy_grid_fwd.hpp>
+
+// LibSmartCar
+#include <bvh/bvh.hpp>
+
+namespace App {
+
+/*
+    2D grid on the ground plane with footprints of the obstacles rasterized into it.
+    Queries cost depends only on the distance travelled over the grid, not on the obstacles count
+*/
+class OccupancyGrid {
+public:
+    // Only boxes crossed by the plane y = plane_height are rasterized
+    void Build(const ObstacleBounds& bounds, const float plane_height, const float cell_size, const bool build_distance_field);
+    void Clear();
+
+    bool IsEmpty() const { return cells_.empty(); }
+    bool HasDistanceField() const { return !distance_field_.empty(); }
+    float GetPlaneHeight() const { return plane_height_; }
+
+    /*
+        Distance along every ray to the first occupied cell (infinity if the ray leaves the grid).
+        Cells are traversed by DDA, with the distance field free space is skipped by sphere tracing.
+        Footprints containing the origin are skipped, same as the boxes containing the origin in other backends,
+        cells they share with other footprints still stop the rays
+    */
+    void IntersectRays(const GL::Vec3& origin, const GL::Vec3* directions, const int rays_count, float* result_distances) const;
+
+    // Distance on the ground plane to the closest occupied cell (up to the cell size), infinity without the distance field
+    float GetNearestObstacleDistance(const GL::Vec3& point) const;
+
+private:
+    struct Footprint {
+        float min_x;
+        float min_z;
+        float max_x;
+        float max_z;
+        // Inclusive range of the rasterized cells
+        int first_x;
+        int first_z;
+        int last_x;
+        int last_z;
+    };
+
+    void ComputeDistanceField();
+
+    // Only the origin cell is looked at, so rays of a car in free space don't depend on the footprints count
+    void FindOriginFootprints(const GL::Vec3& origin, std::vector<int>& footprint_indices) const;
+    float IntersectRay(const GL::Vec3& origin, const GL::Vec3& direction, const std::vector<int>& skipped_footprints) const;
+
+    bool IsOccupied(const int cell_x, const int cell_z) const { return cells_[cell_z * size_x_ + cell_x] != 0; }
+    // Occupied by a footprint other than the skipped ones
+    bool IsBlocked(const int cell_x, const int cell_z, const std::vector<int>& skipped_footprints) const;
+
+    float cell_size_ = 1.0f;
+    float plane_height_ = 0.0f;
+    float min_x_ = 0.0f;
+    float min_z_ = 0.0f;
+    int size_x_ = 0;
+    int size_z_ = 0;
+
+    std::vector<Footprint> footprints_;
+    std::vector<std::uint8_t> cells_; // count of the footprints covering the cell, saturated
+    std::vector<float> distance_field_; // from the cell center to the closest occupied cell center
+};
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace App {
+
+class OccupancyGrid;
+
+} // namespace App
\ No newline at end of file
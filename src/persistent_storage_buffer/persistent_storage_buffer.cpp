@@ -0,0 +1,108 @@
+#include "persistent_storage_buffer.hpp"
+
+namespace App {
+
+// Extern variables
+extern const size_t APP_PERSISTENT_STORAGE_BUFFER_MIN_CAPACITY;
+extern const GLuint64 APP_GPU_FENCE_WAIT_TIMEOUT;
+
+static constexpr GLbitfield APP_PERSISTENT_STORAGE_BUFFER_FLAGS = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+PersistentStorageBuffer::PersistentStorageBuffer(const GLuint binding)
+    : binding_(binding), buffer_(0), capacity_(0), data_(nullptr) {}
+
+PersistentStorageBuffer::~PersistentStorageBuffer() {
+    Release();
+}
+
+void PersistentStorageBuffer::Release() {
+    if (buffer_ == 0) {
+        return;
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer_);
+    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    glDeleteBuffers(1, &buffer_);
+
+    buffer_ = 0;
+    capacity_ = 0;
+    data_ = nullptr;
+}
+
+bool PersistentStorageBuffer::Reserve(const size_t size) {
+    if (size <= capacity_) {
+        return false;
+    }
+
+    size_t new_capacity = (capacity_ > 0) ? capacity_ : APP_PERSISTENT_STORAGE_BUFFER_MIN_CAPACITY;
+    while (new_capacity < size) {
+        new_capacity *= 2;
+    }
+
+    Release();
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer_);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(new_capacity), nullptr, APP_PERSISTENT_STORAGE_BUFFER_FLAGS);
+
+    data_ = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(new_capacity), APP_PERSISTENT_STORAGE_BUFFER_FLAGS);
+    if (!data_) {
+        glDeleteBuffers(1, &buffer_);
+        buffer_ = 0;
+        throw std::runtime_error("PersistentStorageBuffer: Cannot map buffer storage");
+    }
+    capacity_ = new_capacity;
+    return true;
+}
+
+void PersistentStorageBuffer::Write(const void* data, const size_t size, const size_t offset) {
+    if (offset + size > capacity_) {
+        throw std::runtime_error("PersistentStorageBuffer: Write out of buffer capacity");
+    }
+    std::memcpy(static_cast<char*>(data_) + offset, data, size);
+}
+
+void PersistentStorageBuffer::Bind() const {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_, buffer_);
+}
+
+GpuFence::GpuFence()
+    : fence_(nullptr) {}
+
+GpuFence::~GpuFence() {
+    Release();
+}
+
+void GpuFence::Release() {
+    if (fence_) {
+        glDeleteSync(fence_);
+        fence_ = nullptr;
+    }
+}
+
+void GpuFence::Insert() {
+    Release();
+    fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void GpuFence::Wait() {
+    if (!fence_) {
+        return;
+    }
+
+    GLenum status = GL_TIMEOUT_EXPIRED;
+    while (status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(fence_, GL_SYNC_FLUSH_COMMANDS_BIT, APP_GPU_FENCE_WAIT_TIMEOUT);
+    }
+    Release();
+
+    if (status == GL_WAIT_FAILED) {
+        throw std::runtime_error("GpuFence: glClientWaitSync failed");
+    }
+}
+
+void WaitForGpuCommands() {
+    GpuFence fence;
+    fence.Insert();
+    fence.Wait();
+}
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+// STL
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+// OpenGL Wrapper
+#include <GL/OOGL.hpp>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <persistent_storage_buffer/persistent_storage_buffer_fwd.hpp>
+
+namespace App {
+
+/*
+    Shader storage buffer that lives as long as its owner instead of a single dispatch.
+    Storage is immutable (glBufferStorage, OpenGL 4.4) and persistently mapped as coherent,
+    so CPU writes need no uploads and GPU results are read right from the mapping.
+    It grows geometrically, the GL buffer is created on the first Reserve
+*/
+class PersistentStorageBuffer {
+public:
+    PersistentStorageBuffer(const GLuint binding);
+    ~PersistentStorageBuffer();
+
+    PersistentStorageBuffer(const PersistentStorageBuffer&) = delete;
+    PersistentStorageBuffer& operator=(const PersistentStorageBuffer&) = delete;
+
+    // Returns true if the storage was recreated, its previous content is lost in that case
+    bool Reserve(const size_t size);
+
+    void Write(const void* data, const size_t size, const size_t offset = 0);
+    void Bind() const;
+
+    template <typename T>
+    T* GetData() const { return static_cast<T*>(data_); }
+    size_t GetCapacity() const { return capacity_; }
+
+private:
+    void Release();
+
+    const GLuint binding_;
+    GLuint buffer_;
+    size_t capacity_;
+    void* data_;
+};
+
+// Sync object marking the point in the command stream, results before it are ready once it signals
+class GpuFence {
+public:
+    GpuFence();
+    ~GpuFence();
+
+    GpuFence(const GpuFence&) = delete;
+    GpuFence& operator=(const GpuFence&) = delete;
+
+    // Replaces the previous fence, if any
+    void Insert();
+
+    // Does nothing if no fence was inserted since the last wait
+    void Wait();
+
+private:
+    void Release();
+
+    GLsync fence_;
+};
+
+/*
+    WARNING: GL doesn't synchronize persistently mapped buffers,
+    results written by shaders may be read only after the GPU finished them
+*/
+void WaitForGpuCommands();
+
+} // namespace App
\ No newline at end of file
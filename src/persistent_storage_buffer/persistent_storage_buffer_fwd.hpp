@@ -0,0 +1,8 @@
+#pragma once
+
+namespace App {
+
+class PersistentStorageBuffer;
+class GpuFence;
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,613 @@
+#include "ray_intersector.hpp"
+
+namespace App {
+
+// Extern variables
+extern const int APP_INTERSECTOR_NUM_GROUPS_Z_COUNT;
+extern const float APP_OCCUPANCY_GRID_DEFAULT_CELL_SIZE;
+extern const size_t APP_RAY_INTERSECTOR_MIN_CARS_PER_THREAD;
+extern const float APP_RAY_INTERSECTOR_CACHE_POSE_TOLERANCE;
+extern const float APP_RAY_INTERSECTOR_CACHE_MAX_SHIFT;
+
+// Rays are padded to the widest SIMD width, so every packet is full
+constexpr int APP_RAY_INTERSECTOR_MAX_PACKET_SIZE = 16;
+constexpr int APP_RAY_INTERSECTOR_PADDED_RAYS_COUNT = (APP_RAY_INTERSECTOR_RAYS_COUNT + APP_RAY_INTERSECTOR_MAX_PACKET_SIZE - 1)
+    / APP_RAY_INTERSECTOR_MAX_PACKET_SIZE * APP_RAY_INTERSECTOR_MAX_PACKET_SIZE;
+
+// Same as floatBitsToUint and uintBitsToFloat in shaders
+static std::uint32_t FloatToBits(const float value) {
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float BitsToFloat(const std::uint32_t bits) {
+    float value = 0.0f;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Angle in [-pi, pi]
+static float WrapAngle(const float angle) {
+    return std::remainder(angle, static_cast<float>(2.0 * APP_MATH_PI));
+}
+
+RayReadbackSlot::RayReadbackSlot()
+    : ray_ssbo(1), intersection_result_ssbo(2) {}
+
+RayIntersector::RayIntersector(const std::string& intersect_shader_name, const IntersectorBackend backend)
+    : obstacle_registry_(std::make_shared<ObstacleRegistry>()), obstacle_ssbo_(0),
+    grid_cell_size_(APP_OCCUPANCY_GRID_DEFAULT_CELL_SIZE), intersect_shader_name_(intersect_shader_name), backend_(backend),
+    nearest_obstacle_distance_(std::numeric_limits<float>::infinity()) {
+    distances.fill(std::numeric_limits<float>::infinity());
+}
+
+RayIntersector::RayIntersector(const Config::IntersectorConfig& config)
+    : RayIntersector(config.shader.compute_shader_name, config.backend) {
+    SetGridParameters(config.grid.cell_size, config.grid.distance_field);
+    SetReadbackLatency(config.readback_latency);
+    sensor_cache_enabled_ = config.sensor_cache;
+    SetTriangleNarrowphase(config.triangle_narrowphase);
+}
+
+void RayIntersector::SetReadbackLatency(const int readback_latency) {
+    if ((readback_latency < 0) || (readback_latency >= APP_INTERSECTOR_READBACK_RING_SIZE)) {
+        throw std::runtime_error("RayIntersector: readback latency has to be in [0, " + std::to_string(APP_INTERSECTOR_READBACK_RING_SIZE - 1) + "]");
+    }
+    // Results in flight are dropped, so their slots may be reused right away
+    if (dispatches_count_ > 0) {
+        WaitForGpuCommands();
+        dispatches_count_ = 0;
+    }
+    readback_latency_ = readback_latency;
+    sensor_cache_valid_ = false;
+}
+
+void RayIntersector::SetTriangleNarrowphase(const bool enabled) {
+    if (enabled && (backend_ != IntersectorBackend::CPU_SIMD)) {
+        throw std::runtime_error("RayIntersector: triangle narrowphase is supported by CPU_SIMD backend only");
+    }
+    triangle_narrowphase_ = enabled;
+    sensor_cache_valid_ = false;
+}
+
+void RayIntersector::SetGridParameters(const float cell_size, const bool distance_field) {
+    if (cell_size <= 0.0f) {
+        throw std::runtime_error("RayIntersector: grid cell size has to be positive");
+    }
+    grid_cell_size_ = cell_size;
+    grid_distance_field_ = distance_field;
+    obstacle_grid_outdated_ = true;
+    sensor_cache_valid_ = false;
+}
+
+void RayIntersector::SetObstacleRegistry(std::shared_ptr<ObstacleRegistry> obstacle_registry) {
+    obstacle_registry_ = std::move(obstacle_registry);
+    obstacle_ssbo_version_ = 0;
+    obstacle_bvh_version_ = 0;
+    obstacle_grid_version_ = 0;
+    sensor_cache_valid_ = false;
+}
+
+void RayIntersector::Intersect(GL::Mat4 car_model_matrix) {
+    obstacle_registry_->Update();
+    if (IntersectCached(car_model_matrix)) {
+        return;
+    }
+
+    if (backend_ == IntersectorBackend::CPU_SIMD) {
+        UpdateObstacleBvh();
+        IntersectCPU(car_model_matrix, distances.data());
+    } else if (backend_ == IntersectorBackend::CPU_SWEEP) {
+        IntersectSweep(car_model_matrix, distances.data(), sweep_buffers_);
+    } else if (backend_ == IntersectorBackend::GRID) {
+        GL::Vec3 origin = car_model_matrix * GL::Vec3{0.0f, 0.0f, 0.0f};
+        UpdateObstacleGrid(origin.Y);
+        IntersectGrid(car_model_matrix, distances.data());
+        nearest_obstacle_distance_ = obstacle_grid_.GetNearestObstacleDistance(origin);
+    } else {
+        IntersectGPU(car_model_matrix);
+    }
+    UpdateSensorCache(car_model_matrix);
+}
+
+bool RayIntersector::IsSensorCacheUsable() const {
+    // With readback latency distances don't belong to the current pose
+    return sensor_cache_enabled_ && sensor_cache_valid_ && (cached_obstacles_version_ == obstacle_registry_->GetVersion())
+        && ((backend_ != IntersectorBackend::GPU) || (readback_latency_ == 0));
+}
+
+bool RayIntersector::IntersectCached(const GL::Mat4& car_model_matrix) {
+    if (!IsSensorCacheUsable()) {
+        return false;
+    }
+
+    // Pose didn't change within the sensor precision
+    float max_difference = 0.0f;
+    for (int element = 0; element < 16; ++element) {
+        max_difference = (std::max)(max_difference, std::fabs(car_model_matrix.m[element] - cached_car_model_matrix_.m[element]));
+    }
+    if (max_difference <= APP_RAY_INTERSECTOR_CACHE_POSE_TOLERANCE) {
+        return true;
+    }
+
+    if (!HasCacheCandidates()) {
+        return false;
+    }
+
+    /*
+        Cached candidates are all the obstacles within cache_radius_ of the cache origin,
+        so any hit closer than cache_radius_ - shift from the new origin has to be among them.
+        Rays finding nothing that close are not proven, they are traced again one by one through all the obstacles
+    */
+    GL::Vec3 origin = car_model_matrix * GL::Vec3{0.0f, 0.0f, 0.0f};
+    float shift = std::hypot(origin.X - cache_origin_.X, origin.Y - cache_origin_.Y, origin.Z - cache_origin_.Z);
+    if (shift > APP_RAY_INTERSECTOR_CACHE_MAX_SHIFT) {
+        return false;
+    }
+
+    std::array<float, APP_RAY_INTERSECTOR_RAYS_COUNT> candidate_distances{};
+    TraceBvh(cache_bvh_, &cache_obstacle_indices_, car_model_matrix, candidate_distances.data(), cache_radius_ - shift);
+
+    std::array<int, APP_RAY_INTERSECTOR_RAYS_COUNT> unresolved_rays{};
+    int unresolved_count = 0;
+    for (int k = 0; k < APP_RAY_INTERSECTOR_RAYS_COUNT; ++k) {
+        if (std::isinf(candidate_distances[k])) {
+            unresolved_rays[unresolved_count++] = k;
+        }
+    }
+    // Single rays pay off while they are a minority, otherwise the backend traces the fan faster
+    if (2 * unresolved_count > APP_RAY_INTERSECTOR_RAYS_COUNT) {
+        return false;
+    }
+    if (unresolved_count > 0) {
+        UpdateObstacleBvh();
+        auto& directions = GetRayDirections();
+        for (int unresolved_index = 0; unresolved_index < unresolved_count; ++unresolved_index) {
+            int k = unresolved_rays[unresolved_index];
+            GL::Vec4 world_direction = car_model_matrix * GL::Vec4{directions[k].X, directions[k].Y, directions[k].Z, 0.0f};
+            candidate_distances[k] = TraceBvhRay(obstacle_bvh_, nullptr, origin, GL::Vec3{world_direction.X, world_direction.Y, world_direction.Z}.Normal());
+        }
+    }
+
+    distances = candidate_distances;
+    cached_car_model_matrix_ = car_model_matrix;
+    return true;
+}
+
+bool RayIntersector::HasCacheCandidates() const {
+    /*
+        GRID distances are accurate up to a cell only, so they are not mixed with exact ones.
+        GPU traces the whole fan in one dispatch, the candidates and the CPU BVH for the rest of the rays cost more than it saves
+    */
+    return (backend_ == IntersectorBackend::CPU_SIMD) || (backend_ == IntersectorBackend::CPU_SWEEP);
+}
+
+void RayIntersector::UpdateSensorCache(const GL::Mat4& car_model_matrix) {
+    bool candidates_valid = sensor_cache_valid_ && (cached_obstacles_version_ == obstacle_registry_->GetVersion());
+    sensor_cache_valid_ = false;
+    if (!sensor_cache_enabled_ || ((backend_ == IntersectorBackend::GPU) && (readback_latency_ > 0))) {
+        return;
+    }
+
+    cached_car_model_matrix_ = car_model_matrix;
+    cached_obstacles_version_ = obstacle_registry_->GetVersion();
+    sensor_cache_valid_ = true;
+    if (!HasCacheCandidates()) {
+        return;
+    }
+
+    // Candidates stay complete within the max shift of the cache origin, so they are collected again only beyond it
+    GL::Vec3 origin = car_model_matrix * GL::Vec3{0.0f, 0.0f, 0.0f};
+    float shift = std::hypot(origin.X - cache_origin_.X, origin.Y - cache_origin_.Y, origin.Z - cache_origin_.Z);
+    if (candidates_valid && (shift <= APP_RAY_INTERSECTOR_CACHE_MAX_SHIFT)) {
+        return;
+    }
+
+    // Small moves keep most of the rays shorter than the farthest current hit plus the max shift
+    float max_distance = 0.0f;
+    for (float distance : distances) {
+        if (!std::isinf(distance)) {
+            max_distance = (std::max)(max_distance, distance);
+        }
+    }
+
+    cache_origin_ = origin;
+    cache_radius_ = max_distance + 2.0f * APP_RAY_INTERSECTOR_CACHE_MAX_SHIFT;
+
+    const ObstacleBounds& obstacle_bounds = obstacle_registry_->GetBounds();
+    cache_bounds_.Clear();
+    cache_obstacle_indices_.clear();
+    for (size_t obstacle_index = 0; obstacle_index < obstacle_bounds.GetSize(); ++obstacle_index) {
+        float dx = (std::max)({obstacle_bounds.min_x[obstacle_index] - cache_origin_.X, 0.0f, cache_origin_.X - obstacle_bounds.max_x[obstacle_index]});
+        float dy = (std::max)({obstacle_bounds.min_y[obstacle_index] - cache_origin_.Y, 0.0f, cache_origin_.Y - obstacle_bounds.max_y[obstacle_index]});
+        float dz = (std::max)({obstacle_bounds.min_z[obstacle_index] - cache_origin_.Z, 0.0f, cache_origin_.Z - obstacle_bounds.max_z[obstacle_index]});
+        if (dx * dx + dy * dy + dz * dz <= cache_radius_ * cache_radius_) {
+            cache_bounds_.Add(
+                GL::Vec3{obstacle_bounds.min_x[obstacle_index], obstacle_bounds.min_y[obstacle_index], obstacle_bounds.min_z[obstacle_index]},
+                GL::Vec3{obstacle_bounds.max_x[obstacle_index], obstacle_bounds.max_y[obstacle_index], obstacle_bounds.max_z[obstacle_index]}
+            );
+            cache_obstacle_indices_.push_back(static_cast<int>(obstacle_index));
+        }
+    }
+    cache_bvh_.Build(cache_bounds_);
+}
+
+void RayIntersector::IntersectBatch(const std::vector<GL::Mat4>& car_model_matrices, std::vector<float>& batch_distances) {
+    const size_t cars_count = car_model_matrices.size();
+    batch_distances.resize(cars_count * APP_RAY_INTERSECTOR_RAYS_COUNT);
+    if (cars_count == 0) {
+        return;
+    }
+    obstacle_registry_->Update();
+
+    if (backend_ == IntersectorBackend::GPU) {
+        IntersectBatchGPU(car_model_matrices, batch_distances);
+        return;
+    }
+
+    // Acceleration structures are shared by all the cars, so they are updated before the workers start
+    if (backend_ == IntersectorBackend::CPU_SIMD) {
+        UpdateObstacleBvh();
+    } else if (backend_ == IntersectorBackend::GRID) {
+        // WARNING: the grid is a slice at the rays height of the first car, other cars are expected at the same height
+        UpdateObstacleGrid((car_model_matrices[0] * GL::Vec3{0.0f, 0.0f, 0.0f}).Y);
+    }
+
+    ParallelFor(cars_count, APP_RAY_INTERSECTOR_MIN_CARS_PER_THREAD, [this, &car_model_matrices, &batch_distances](const size_t begin, const size_t end) {
+        // Workers can't share the member buffers, so every range reuses its own ones for all of its cars
+        SweepBuffers range_sweep_buffers;
+        for (size_t car_index = begin; car_index < end; ++car_index) {
+            float* car_distances = batch_distances.data() + car_index * APP_RAY_INTERSECTOR_RAYS_COUNT;
+            if (backend_ == IntersectorBackend::CPU_SIMD) {
+                IntersectCPU(car_model_matrices[car_index], car_distances);
+            } else if (backend_ == IntersectorBackend::CPU_SWEEP) {
+                IntersectSweep(car_model_matrices[car_index], car_distances, range_sweep_buffers);
+            } else {
+                IntersectGrid(car_model_matrices[car_index], car_distances);
+            }
+        }
+    });
+}
+
+const std::array<GL::Vec3, APP_RAY_INTERSECTOR_RAYS_COUNT>& RayIntersector::GetRayDirections() {
+    static const std::array<GL::Vec3, APP_RAY_INTERSECTOR_RAYS_COUNT> directions = [] {
+        static_assert(APP_RAY_INTERSECTOR_RAYS_COUNT > 1);
+        std::array<GL::Vec3, APP_RAY_INTERSECTOR_RAYS_COUNT> result{};
+
+        float coef = APP_MATH_PI / (APP_RAY_INTERSECTOR_RAYS_COUNT - 1);
+        for (int k = 0; k < APP_RAY_INTERSECTOR_RAYS_COUNT; ++k) {
+            result[k] = GL::Vec3{std::cos(coef * k), 0.0f, std::sin(coef * k)};
+        }
+        return result;
+    }();
+    return directions;
+}
+
+void RayIntersector::UpdateObstacleSsbo() {
+    if (obstacle_ssbo_version_ == obstacle_registry_->GetVersion()) {
+        return;
+    }
+
+    // WARNING: dispatches in flight still read the old obstacles
+    if (readback_latency_ > 0) {
+        WaitForGpuCommands();
+    }
+    obstacle_registry_->WriteWorldBBoxes(obstacle_ssbo_, obstacle_ssbo_version_);
+}
+
+void RayIntersector::DispatchGPU(RayReadbackSlot& slot, const GL::Mat4* car_model_matrices, const size_t cars_count) {
+    // Obstacles are uploaded only after they change
+    UpdateObstacleSsbo();
+
+    const size_t rays_count = cars_count * APP_RAY_INTERSECTOR_RAYS_COUNT;
+
+    // Rays and results are written right into the mapped memory
+    slot.ray_ssbo.Reserve(rays_count * sizeof(Ray));
+    slot.intersection_result_ssbo.Reserve(rays_count * sizeof(std::uint32_t));
+
+    Ray* rays = slot.ray_ssbo.GetData<Ray>();
+    auto& directions = GetRayDirections();
+    for (size_t car_index = 0; car_index < cars_count; ++car_index) {
+        Ray* car_rays = rays + car_index * APP_RAY_INTERSECTOR_RAYS_COUNT;
+        for (int k = 0; k < APP_RAY_INTERSECTOR_RAYS_COUNT; ++k) {
+            car_rays[k] = Ray{GL::Vec4{0.000, 0.000, 0.000, 1.000}, GL::Vec4{directions[k].X, directions[k].Y, directions[k].Z, 0.000}, car_model_matrices[car_index]};
+        }
+    }
+
+    // Running minimum of every ray is kept by the shader, so only one value per ray is read back
+    std::uint32_t* intersection_results = slot.intersection_result_ssbo.GetData<std::uint32_t>();
+    std::fill(intersection_results, intersection_results + rays_count, FloatToBits(std::numeric_limits<float>::infinity()));
+
+    auto& context = App::Context::Get();
+    auto& gl = context.gl->get();
+    auto shader_handler = context.shader_handler.value();
+
+    auto intersect_program = shader_handler.at(intersect_shader_name_);
+    gl.UseProgram(*intersect_program);
+    intersect_program->SetUniform(intersect_program->GetUniform("obstacles_count"), static_cast<int>(obstacle_registry_->GetBoxesCount()));
+    intersect_program->SetUniform(intersect_program->GetUniform("rays_count"), static_cast<int>(rays_count));
+
+    obstacle_ssbo_.Bind();
+    slot.ray_ssbo.Bind();
+    slot.intersection_result_ssbo.Bind();
+
+    // Execute compute shader: tiles of rays along X, tiles of obstacles along Y
+    int tile_size = GetComputeTileSize(intersect_shader_name_);
+    gl.DispatchCompute(GetComputeTilesCount(rays_count, tile_size), GetComputeTilesCount(obstacle_registry_->GetBoxesCount(), tile_size), APP_INTERSECTOR_NUM_GROUPS_Z_COUNT);
+    gl.Barrier(GL::BarrierBit::All);
+    slot.fence.Insert();
+}
+
+void RayIntersector::IntersectGPU(const GL::Mat4& car_model_matrix) {
+    // Slot of this dispatch was read back at least one call ago, since latency is less than the ring size
+    RayReadbackSlot& slot = readback_slots_[dispatches_count_ % APP_INTERSECTOR_READBACK_RING_SIZE];
+    DispatchGPU(slot, &car_model_matrix, 1);
+    ++dispatches_count_;
+
+    // Get the results of the dispatch issued readback_latency_ calls ago back on CPU
+    if (dispatches_count_ <= static_cast<size_t>(readback_latency_)) {
+        return;
+    }
+    RayReadbackSlot& ready_slot = readback_slots_[(dispatches_count_ - 1 - readback_latency_) % APP_INTERSECTOR_READBACK_RING_SIZE];
+    ready_slot.fence.Wait();
+
+    const std::uint32_t* ready_results = ready_slot.intersection_result_ssbo.GetData<std::uint32_t>();
+    for (int ray_id = 0; ray_id < APP_RAY_INTERSECTOR_RAYS_COUNT; ++ray_id) {
+        distances[ray_id] = BitsToFloat(ready_results[ray_id]);
+    }
+}
+
+void RayIntersector::IntersectBatchGPU(const std::vector<GL::Mat4>& car_model_matrices, std::vector<float>& batch_distances) {
+    // Batches are always read back synchronously, their slot is never shared with single car dispatches
+    DispatchGPU(batch_slot_, car_model_matrices.data(), car_model_matrices.size());
+    batch_slot_.fence.Wait();
+
+    const std::uint32_t* batch_results = batch_slot_.intersection_result_ssbo.GetData<std::uint32_t>();
+    for (size_t ray_id = 0; ray_id < batch_distances.size(); ++ray_id) {
+        batch_distances[ray_id] = BitsToFloat(batch_results[ray_id]);
+    }
+}
+
+void RayIntersector::UpdateObstacleBvh() {
+    if (obstacle_bvh_version_ != obstacle_registry_->GetVersion()) {
+        obstacle_bvh_.Build(obstacle_registry_->GetBounds());
+        obstacle_bvh_version_ = obstacle_registry_->GetVersion();
+    }
+}
+
+void RayIntersector::UpdateObstacleGrid(const float plane_height) {
+    // Grid is a slice at the rays height, so it is also rebuilt if the car leaves that height
+    if (obstacle_grid_outdated_ || (obstacle_grid_version_ != obstacle_registry_->GetVersion()) || (obstacle_grid_.GetPlaneHeight() != plane_height)) {
+        obstacle_grid_.Build(obstacle_registry_->GetBounds(), plane_height, grid_cell_size_, grid_distance_field_);
+        obstacle_grid_version_ = obstacle_registry_->GetVersion();
+        obstacle_grid_outdated_ = false;
+    }
+}
+
+void RayIntersector::IntersectCPU(const GL::Mat4& car_model_matrix, float* result_distances) const {
+    TraceBvh(obstacle_bvh_, nullptr, car_model_matrix, result_distances);
+}
+
+void RayIntersector::TraceBvh(const Bvh& bvh, const std::vector<int>* obstacle_indices, const GL::Mat4& car_model_matrix, float* result_distances,
+    const float max_distance) const {
+    // All the rays start from the car origin, only directions differ
+    GL::Vec3 origin = car_model_matrix * GL::Vec3{0.0f, 0.0f, 0.0f};
+
+    std::array<float, APP_RAY_INTERSECTOR_PADDED_RAYS_COUNT> direction_x{};
+    std::array<float, APP_RAY_INTERSECTOR_PADDED_RAYS_COUNT> direction_y{};
+    std::array<float, APP_RAY_INTERSECTOR_PADDED_RAYS_COUNT> direction_z{};
+    std::array<float, APP_RAY_INTERSECTOR_PADDED_RAYS_COUNT> result{};
+
+    auto& directions = GetRayDirections();
+    for (int k = 0; k < APP_RAY_INTERSECTOR_PADDED_RAYS_COUNT; ++k) {
+        // Padding rays repeat the last one, their results are dropped
+        const GL::Vec3& direction = directions[(std::min)(k, APP_RAY_INTERSECTOR_RAYS_COUNT - 1)];
+        GL::Vec4 world_direction = car_model_matrix * GL::Vec4{direction.X, direction.Y, direction.Z, 0.0f};
+        GL::Vec3 normalized_direction = GL::Vec3{world_direction.X, world_direction.Y, world_direction.Z}.Normal();
+
+        direction_x[k] = normalized_direction.X;
+        direction_y[k] = normalized_direction.Y;
+        direction_z[k] = normalized_direction.Z;
+    }
+
+    // Rays descend into the meshes one by one, the top level BVH keeps the number of narrowphase calls small
+    if (triangle_narrowphase_) {
+        for (int k = 0; k < APP_RAY_INTERSECTOR_RAYS_COUNT; ++k) {
+            result_distances[k] = TraceBvhRay(bvh, obstacle_indices, origin, GL::Vec3{direction_x[k], direction_y[k], direction_z[k]}, max_distance);
+        }
+        return;
+    }
+
+    bvh.IntersectRays(origin, direction_x.data(), direction_y.data(), direction_z.data(),
+        result.data(), APP_RAY_INTERSECTOR_PADDED_RAYS_COUNT, max_distance);
+
+    std::copy(result.begin(), result.begin() + APP_RAY_INTERSECTOR_RAYS_COUNT, result_distances);
+}
+
+float RayIntersector::TraceBvhRay(const Bvh& bvh, const std::vector<int>* obstacle_indices, const GL::Vec3& origin, const GL::Vec3& direction,
+    const float max_distance) const {
+    if (!triangle_narrowphase_) {
+        float distance = bvh.IntersectRay(origin, direction);
+        return (distance < max_distance) ? distance : std::numeric_limits<float>::infinity();
+    }
+    return bvh.IntersectRay(origin, direction, [&](const int box_index, const float box_distance, const float nearest) {
+        int obstacle_index = obstacle_indices ? (*obstacle_indices)[box_index] : box_index;
+        return IntersectObstacleTriangles(obstacle_index, origin, direction, box_distance, nearest);
+    }, max_distance);
+}
+
+float RayIntersector::IntersectObstacleTriangles(const int obstacle_index, const GL::Vec3& origin, const GL::Vec3& direction,
+    const float box_distance, const float nearest) const {
+    const ObstacleTriangles& triangles = obstacle_registry_->GetTriangles()[obstacle_index];
+    if (!triangles.bvh || triangles.bvh->IsEmpty()) {
+        return box_distance;
+    }
+
+    // Affine transform keeps the ray parameter, so mesh space t is still the world distance
+    GL::Vec3 mesh_origin = triangles.world_to_mesh * origin;
+    GL::Vec4 mesh_direction = triangles.world_to_mesh * GL::Vec4{direction.X, direction.Y, direction.Z, 0.0f};
+    return triangles.bvh->IntersectRay(mesh_origin, GL::Vec3{mesh_direction.X, mesh_direction.Y, mesh_direction.Z}, nearest);
+}
+
+void RayIntersector::IntersectSweep(const GL::Mat4& car_model_matrix, float* result_distances, SweepBuffers& buffers) const {
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    constexpr float angle_eps = 1e-5f;
+
+    GL::Vec3 origin = car_model_matrix * GL::Vec3{0.0f, 0.0f, 0.0f};
+
+    // Angles are measured from the middle ray, so the whole fan lies in [-pi / 2, pi / 2]
+    auto& directions = GetRayDirections();
+    const GL::Vec3& middle_direction = directions[APP_RAY_INTERSECTOR_RAYS_COUNT / 2];
+    GL::Vec4 world_middle_direction = car_model_matrix * GL::Vec4{middle_direction.X, middle_direction.Y, middle_direction.Z, 0.0f};
+    const float middle_angle = std::atan2(world_middle_direction.Z, world_middle_direction.X);
+
+    std::array<float, APP_RAY_INTERSECTOR_RAYS_COUNT> ray_x{};
+    std::array<float, APP_RAY_INTERSECTOR_RAYS_COUNT> ray_z{};
+    std::array<float, APP_RAY_INTERSECTOR_RAYS_COUNT> ray_angle{};
+    std::array<int, APP_RAY_INTERSECTOR_RAYS_COUNT> ray_order{};
+
+    for (int k = 0; k < APP_RAY_INTERSECTOR_RAYS_COUNT; ++k) {
+        GL::Vec4 world_direction = car_model_matrix * GL::Vec4{directions[k].X, directions[k].Y, directions[k].Z, 0.0f};
+        GL::Vec3 normalized_direction = GL::Vec3{world_direction.X, world_direction.Y, world_direction.Z}.Normal();
+
+        ray_x[k] = normalized_direction.X;
+        ray_z[k] = normalized_direction.Z;
+        ray_angle[k] = WrapAngle(std::atan2(ray_z[k], ray_x[k]) - middle_angle);
+    }
+    std::iota(ray_order.begin(), ray_order.end(), 0);
+    std::sort(ray_order.begin(), ray_order.end(), [&ray_angle](const int lhs, const int rhs) {
+        return ray_angle[lhs] < ray_angle[rhs];
+    });
+
+    // Only obstacles crossed by the rays plane are seen, obstacles around the car origin are skipped as in other backends
+    const ObstacleBounds& obstacle_bounds = obstacle_registry_->GetBounds();
+    std::vector<SweepFootprint>& footprints = buffers.footprints;
+    std::vector<SweepArc>& arcs = buffers.arcs;
+    footprints.clear();
+    arcs.clear();
+
+    for (size_t obstacle_index = 0; obstacle_index < obstacle_bounds.GetSize(); ++obstacle_index) {
+        if ((origin.Y < obstacle_bounds.min_y[obstacle_index]) || (obstacle_bounds.max_y[obstacle_index] < origin.Y)) {
+            continue;
+        }
+
+        SweepFootprint footprint{
+            obstacle_bounds.min_x[obstacle_index], obstacle_bounds.min_z[obstacle_index],
+            obstacle_bounds.max_x[obstacle_index], obstacle_bounds.max_z[obstacle_index],
+            0.0f
+        };
+
+        float closest_x = std::clamp(origin.X, footprint.min_x, footprint.max_x);
+        float closest_z = std::clamp(origin.Z, footprint.min_z, footprint.max_z);
+        if ((closest_x == origin.X) && (closest_z == origin.Z)) {
+            continue;
+        }
+        footprint.min_distance = std::hypot(closest_x - origin.X, closest_z - origin.Z);
+
+        // Footprint is convex and doesn't contain the origin, so its corners span less than pi around the origin
+        float center_angle = WrapAngle(std::atan2(
+            0.5f * (footprint.min_z + footprint.max_z) - origin.Z,
+            0.5f * (footprint.min_x + footprint.max_x) - origin.X
+        ) - middle_angle);
+
+        SweepArc arc{infinity, -infinity, static_cast<int>(footprints.size())};
+        for (int corner_index = 0; corner_index < 4; ++corner_index) {
+            float corner_x = (corner_index & 1) ? footprint.max_x : footprint.min_x;
+            float corner_z = (corner_index & 2) ? footprint.max_z : footprint.min_z;
+            float corner_angle = center_angle + WrapAngle(std::atan2(corner_z - origin.Z, corner_x - origin.X) - middle_angle - center_angle);
+
+            arc.start_angle = (std::min)(arc.start_angle, corner_angle);
+            arc.end_angle = (std::max)(arc.end_angle, corner_angle);
+        }
+        footprints.push_back(footprint);
+
+        const float pi = static_cast<float>(APP_MATH_PI);
+        if (arc.start_angle < -pi) {
+            arcs.push_back(SweepArc{arc.start_angle + 2.0f * pi, pi, arc.footprint_index});
+            arc.start_angle = -pi;
+        } else if (arc.end_angle > pi) {
+            arcs.push_back(SweepArc{-pi, arc.end_angle - 2.0f * pi, arc.footprint_index});
+            arc.end_angle = pi;
+        }
+        arcs.push_back(arc);
+    }
+
+    const int arcs_count = static_cast<int>(arcs.size());
+    std::vector<int>& start_order = buffers.start_order;
+    std::vector<int>& end_order = buffers.end_order;
+    start_order.resize(arcs_count);
+    end_order.resize(arcs_count);
+    std::iota(start_order.begin(), start_order.end(), 0);
+    std::iota(end_order.begin(), end_order.end(), 0);
+    std::sort(start_order.begin(), start_order.end(), [&arcs](const int lhs, const int rhs) {
+        return arcs[lhs].start_angle < arcs[rhs].start_angle;
+    });
+    std::sort(end_order.begin(), end_order.end(), [&arcs](const int lhs, const int rhs) {
+        return arcs[lhs].end_angle < arcs[rhs].end_angle;
+    });
+
+    /*
+        Footprints covering the current angle ordered by their min distance.
+        A sorted vector is scanned from the front by every ray anyway, so it beats a tree on insertions and removals too
+    */
+    std::vector<std::pair<float, int>>& active_footprints = buffers.active_footprints;
+    active_footprints.clear();
+    int next_start = 0;
+    int next_end = 0;
+
+    for (int ray_index : ray_order) {
+        const float angle = ray_angle[ray_index];
+        while ((next_start < arcs_count) && (arcs[start_order[next_start]].start_angle <= angle + angle_eps)) {
+            int footprint_index = arcs[start_order[next_start++]].footprint_index;
+            auto key = std::make_pair(footprints[footprint_index].min_distance, footprint_index);
+            active_footprints.insert(std::lower_bound(active_footprints.begin(), active_footprints.end(), key), key);
+        }
+        while ((next_end < arcs_count) && (arcs[end_order[next_end]].end_angle < angle - angle_eps)) {
+            int footprint_index = arcs[end_order[next_end++]].footprint_index;
+            auto key = std::make_pair(footprints[footprint_index].min_distance, footprint_index);
+            auto position = std::lower_bound(active_footprints.begin(), active_footprints.end(), key);
+            if ((position != active_footprints.end()) && (*position == key)) {
+                active_footprints.erase(position);
+            }
+        }
+
+        // Usually the closest footprint is hit, the rest are cut off by their min distance
+        const float inverse_x = (std::fabs(ray_x[ray_index]) < 1e-20f) ? std::copysign(1e20f, ray_x[ray_index]) : 1.0f / ray_x[ray_index];
+        const float inverse_z = (std::fabs(ray_z[ray_index]) < 1e-20f) ? std::copysign(1e20f, ray_z[ray_index]) : 1.0f / ray_z[ray_index];
+
+        float nearest = infinity;
+        for (auto& [min_distance, footprint_index] : active_footprints) {
+            if (min_distance >= nearest) {
+                break;
+            }
+
+            const SweepFootprint& footprint = footprints[footprint_index];
+            float t_min_x = (footprint.min_x - origin.X) * inverse_x;
+            float t_max_x = (footprint.max_x - origin.X) * inverse_x;
+            float t_min_z = (footprint.min_z - origin.Z) * inverse_z;
+            float t_max_z = (footprint.max_z - origin.Z) * inverse_z;
+
+            float t_near = (std::max)((std::min)(t_min_x, t_max_x), (std::min)(t_min_z, t_max_z));
+            float t_far = (std::min)((std::max)(t_min_x, t_max_x), (std::max)(t_min_z, t_max_z));
+            if ((t_near <= t_far) && (t_near > 0.0f)) {
+                nearest = (std::min)(nearest, t_near);
+            }
+        }
+        result_distances[ray_index] = nearest;
+    }
+}
+
+void RayIntersector::IntersectGrid(const GL::Mat4& car_model_matrix, float* result_distances) const {
+    GL::Vec3 origin = car_model_matrix * GL::Vec3{0.0f, 0.0f, 0.0f};
+
+    std::array<GL::Vec3, APP_RAY_INTERSECTOR_RAYS_COUNT> world_directions{};
+    auto& directions = GetRayDirections();
+    for (int k = 0; k < APP_RAY_INTERSECTOR_RAYS_COUNT; ++k) {
+        GL::Vec4 world_direction = car_model_matrix * GL::Vec4{directions[k].X, directions[k].Y, directions[k].Z, 0.0f};
+        world_directions[k] = GL::Vec3{world_direction.X, world_direction.Y, world_direction.Z}.Normal();
+    }
+    obstacle_grid_.IntersectRays(origin, world_directions.data(), APP_RAY_INTERSECTOR_RAYS_COUNT, result_distances);
+}
+
+} // namespace App
\ No newline at end of file
@@ -3,6 +3,14 @@
 // STL
 #define NOMINMAX
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <vector>
 
 // OpenGL Wrapper
 #include <GL/OOGL.hpp>
@@ -11,11 +19,15 @@
 #include <constants/constants.hpp>
 
 // Forward declarations
-#include <intersector/intersector_fwd.hpp>
+#include <ray_intersector/ray_intersector_fwd.hpp>
 
 // LibSmartCar
 #include <helpers/helpers.hpp>
 #include <config/config_handler.hpp>
+#include <bvh/bvh.hpp>
+#include <obstacle_registry/obstacle_registry.hpp>
+#include <occupancy_grid/occupancy_grid.hpp>
+#include <persistent_storage_buffer/persistent_storage_buffer.hpp>
 #include <car_model/car_model.hpp>
 
 namespace App {
@@ -26,94 +38,180 @@ struct Ray {
     GL::Mat4 car_model_matrix;
 };
 
-class RayIntersector {
-public:
-    RayIntersector(const std::string& intersect_shader_name)
-    : intersect_shader_name_(intersect_shader_name) {
-        distances.fill(std::numeric_limits<float>::infinity());
-    }
-
-    RayIntersector(const Config::IntersectorConfig& config)
-    : RayIntersector(config.shader.compute_shader_name) {
-        distances.fill(std::numeric_limits<float>::infinity());
-    }
-
-    void ClearObstacles() {
-        obstacle_bboxes_.clear();
-        current_obstacle_index_ = 0;
-    }
-
-    void AddObstacles(const Model* model) {
-        std::vector<MemoryAlignedBBox> new_obstacle_bboxes = model->CollectMABB();
-        obstacle_bboxes_.reserve(obstacle_bboxes_.size() + new_obstacle_bboxes.size());
-
-        for (int bbox_index = 0; bbox_index < new_obstacle_bboxes.size(); ++bbox_index) {
-            obstacle_bboxes_.push_back(new_obstacle_bboxes[bbox_index]);
-            // obstacle_index_to_model_index_mesh_index[obstacle_bboxes_.size() - 1] = std::make_pair(current_obstacle_index_, bbox_index);
-        }
-        ++current_obstacle_index_;
-    }
-
-    void Intersect(GL::Mat4 car_model_matrix) {
-        // TODO: get rid of magic numbers
-        // TODO: fix code (with SubData) instead of generating buffer object every frame
-        // TODO: fix SubData and GetSubData in OOGL (check if they need glBindBufferBase)
-
-        std::array<Ray, APP_RAY_INTERSECTOR_RAYS_COUNT> rays_;
-
-        assert(APP_RAY_INTERSECTOR_RAYS_COUNT > 1);
-        float coef = APP_MATH_PI / (APP_RAY_INTERSECTOR_RAYS_COUNT - 1);
-        for (int k = 0; k < APP_RAY_INTERSECTOR_RAYS_COUNT; ++k) {
-            float x_component = std::cos(coef * k);
-            float z_component = std::sin(coef * k);
-
-            rays_[k] = Ray{GL::Vec4{0.000, 0.000, 0.000, 1.000}, GL::Vec4{x_component, 0.000, z_component, 0.000}, car_model_matrix};
-        }
+// Per-dispatch GPU buffers, the ring lets the CPU fill the next one while the GPU still works on the previous
+struct RayReadbackSlot {
+    RayReadbackSlot();
 
-        auto& context = App::Context::Get();
-        auto& gl = context.gl->get();
-        auto shader_handler = context.shader_handler.value();
-
-        auto intersect_program = shader_handler.at(intersect_shader_name_);
-        gl.UseProgram(*intersect_program);
-
-        auto obstacle_ssbo = GL::StorageBuffer(obstacle_bboxes_.data(), obstacle_bboxes_.size() * sizeof(MemoryAlignedBBox), GL::BufferUsage::StaticRead, 0);
-        auto car_parts_ssbo = GL::StorageBuffer(rays_.data(), rays_.size() * sizeof(Ray), GL::BufferUsage::StaticRead, 1);
-
-        std::vector<float> intersection_results(obstacle_bboxes_.size() * rays_.size(), -1.0);
-        auto intersection_result_ssbo = GL::StorageBuffer(intersection_results.data(), intersection_results.size() * sizeof(float), GL::BufferUsage::DynamicDraw, 2);
+    PersistentStorageBuffer ray_ssbo;
+    PersistentStorageBuffer intersection_result_ssbo;
+    GpuFence fence;
+};
 
-        // Execute compute shader
-        gl.DispatchCompute(obstacle_bboxes_.size(), rays_.size(), APP_INTERSECTOR_NUM_GROUPS_Z_COUNT);
-        gl.Barrier(GL::BarrierBit::All);
+struct SweepFootprint {
+    float min_x;
+    float min_z;
+    float max_x;
+    float max_z;
+    float min_distance; // no ray can hit the footprint closer than that
+};
 
-        // Get the results back on CPU
-        auto read_data = intersection_result_ssbo.Map<float>(GL::BufferAccess::ReadOnly);
-        distances.fill(std::numeric_limits<float>::infinity());
+// Angular interval covered by the footprint, intervals crossing +-pi are split in two
+struct SweepArc {
+    float start_angle;
+    float end_angle;
+    int footprint_index;
+};
 
-        for (int i = 0; i < intersection_results.size(); ++i) {
-            if (read_data[i] > 0) {
-                // i = obstacle_id * rays_size + ray_id
-                int obstacle_id = i / rays_.size();
-                int ray_id = i % rays_.size();
+// Scratch memory of the sweep, reused between calls so a sweep doesn't allocate once the sizes settle
+struct SweepBuffers {
+    std::vector<SweepFootprint> footprints;
+    std::vector<SweepArc> arcs;
+    std::vector<int> start_order;
+    std::vector<int> end_order;
+    std::vector<std::pair<float, int>> active_footprints; // sorted by min distance
+};
 
-                distances[ray_id] = std::min<float>(distances[ray_id], read_data[i]);
-            }
-        }
-    }
+class RayIntersector {
+public:
+    RayIntersector(const std::string& intersect_shader_name, const IntersectorBackend backend = IntersectorBackend::GPU);
+    RayIntersector(const Config::IntersectorConfig& config);
+
+    /*
+        GPU backend only: results of an Intersect call become available that many calls later,
+        so the CPU doesn't wait for the dispatch. Zero (default) means synchronous readback
+    */
+    void SetReadbackLatency(const int readback_latency);
+
+    /*
+        CPU_SIMD backend only: boxes hit by a ray are refined by the triangles of their meshes,
+        so rotated models don't block rays with the empty corners of their world boxes
+    */
+    void SetTriangleNarrowphase(const bool enabled);
+
+    // Obstacles are kept in the registry, which may be shared with other sensors of the world
+    void SetObstacleRegistry(std::shared_ptr<ObstacleRegistry> obstacle_registry);
+    std::shared_ptr<ObstacleRegistry> GetObstacleRegistry() const { return obstacle_registry_; }
+
+    void Intersect(GL::Mat4 car_model_matrix);
+
+    /*
+        Rays of all the cars at once: distances of the car i are stored at
+        [i * APP_RAY_INTERSECTOR_RAYS_COUNT, (i + 1) * APP_RAY_INTERSECTOR_RAYS_COUNT).
+        GPU backend runs a single synchronous dispatch, CPU backends split the cars between threads.
+        Results of single car Intersect calls are not affected
+    */
+    void IntersectBatch(const std::vector<GL::Mat4>& car_model_matrices, std::vector<float>& batch_distances);
 
     std::array<float, APP_RAY_INTERSECTOR_RAYS_COUNT> GetResultDistances() const {
         return distances;
     }
 
-private:
-    int current_obstacle_index_ = 0;
+    IntersectorBackend GetBackend() const { return backend_; }
 
-    std::vector<MemoryAlignedBBox> obstacle_bboxes_;
+    // GRID backend with the distance field only, infinity otherwise
+    float GetNearestObstacleDistance() const { return nearest_obstacle_distance_; }
+
+    // GRID backend settings, the grid is rebuilt on the next Intersect
+    void SetGridParameters(const float cell_size, const bool distance_field);
+
+private:
+    // Directions in car space: 180 degrees fan on the ground plane
+    static const std::array<GL::Vec3, APP_RAY_INTERSECTOR_RAYS_COUNT>& GetRayDirections();
+
+    /*
+        Sensor cache: distances are kept while neither the pose (within the sensor precision) nor the obstacles change.
+        After small moves CPU backends trace rays only through the candidate obstacles around the cache origin,
+        the few rays not resolved there are traced through all the obstacles one by one
+    */
+    bool IsSensorCacheUsable() const;
+    bool HasCacheCandidates() const;
+    bool IntersectCached(const GL::Mat4& car_model_matrix);
+    void UpdateSensorCache(const GL::Mat4& car_model_matrix);
+
+    /*
+        Only hits closer than max_distance are reported.
+        Boxes of the BVH are mapped to the obstacles by obstacle_indices (same indices if nullptr)
+    */
+    void TraceBvh(const Bvh& bvh, const std::vector<int>* obstacle_indices, const GL::Mat4& car_model_matrix, float* result_distances,
+        const float max_distance = std::numeric_limits<float>::infinity()) const;
+
+    // Same for a single ray, the fan is traced in packets when triangles are not refined
+    float TraceBvhRay(const Bvh& bvh, const std::vector<int>* obstacle_indices, const GL::Vec3& origin, const GL::Vec3& direction,
+        const float max_distance = std::numeric_limits<float>::infinity()) const;
+
+    // Narrowphase of the obstacle box hit, meshes without triangles keep the box distance
+    float IntersectObstacleTriangles(const int obstacle_index, const GL::Vec3& origin, const GL::Vec3& direction,
+        const float box_distance, const float nearest) const;
+
+    void UpdateObstacleSsbo();
+    void UpdateObstacleBvh();
+    void UpdateObstacleGrid(const float plane_height);
+
+    // Fills the rays of all the cars and inserts the slot fence after the dispatch
+    void DispatchGPU(RayReadbackSlot& slot, const GL::Mat4* car_model_matrices, const size_t cars_count);
+
+    /*
+        Compute shader, the closest t value of every ray is reduced on GPU.
+        With readback latency distances stay infinite until the first results are ready
+    */
+    void IntersectGPU(const GL::Mat4& car_model_matrix);
+    void IntersectBatchGPU(const std::vector<GL::Mat4>& car_model_matrices, std::vector<float>& batch_distances);
+
+    // CPU backends below only read prepared obstacle data, so cars may be processed in parallel
+
+    // Packets of rays traverse the obstacles BVH, keeping the running minimum per ray
+    void IntersectCPU(const GL::Mat4& car_model_matrix, float* result_distances) const;
+
+    /*
+        Rays are horizontal and obstacles are upright boxes, so the problem is 2D:
+        footprints of obstacles are sorted by their angular intervals around the car
+        and all the rays are filled in one sweep over the angle.
+        Every ray tests only the footprints covering its angle until their min distance exceeds the hit,
+        so sparse scenes cost O(n log n + rays), but many footprints overlapping in angle degrade it to O(n * rays)
+    */
+    void IntersectSweep(const GL::Mat4& car_model_matrix, float* result_distances, SweepBuffers& buffers) const;
+
+    // Footprints are rasterized once, rays are traced over the grid by DDA (and sphere tracing with the distance field)
+    void IntersectGrid(const GL::Mat4& car_model_matrix, float* result_distances) const;
+
+    // Structures below are rebuilt when their version differs from the registry one
+    std::shared_ptr<ObstacleRegistry> obstacle_registry_;
+    bool triangle_narrowphase_ = false;
+
+    // GPU backend buffers live as long as the intersector
+    PersistentStorageBuffer obstacle_ssbo_;
+    size_t obstacle_ssbo_version_ = 0;
+    std::array<RayReadbackSlot, APP_INTERSECTOR_READBACK_RING_SIZE> readback_slots_;
+    RayReadbackSlot batch_slot_;
+    size_t dispatches_count_ = 0;
+    int readback_latency_ = 0;
+
+    Bvh obstacle_bvh_;
+    size_t obstacle_bvh_version_ = 0;
+
+    SweepBuffers sweep_buffers_;
+
+    OccupancyGrid obstacle_grid_;
+    size_t obstacle_grid_version_ = 0;
+    bool obstacle_grid_outdated_ = true; // grid parameters changed
+    float grid_cell_size_;
+    bool grid_distance_field_ = false;
+
+    bool sensor_cache_enabled_ = true;
+    bool sensor_cache_valid_ = false;
+    size_t cached_obstacles_version_ = 0;
+    GL::Mat4 cached_car_model_matrix_;
+    GL::Vec3 cache_origin_;
+    float cache_radius_ = 0.0f;
+    ObstacleBounds cache_bounds_;
+    std::vector<int> cache_obstacle_indices_;
+    Bvh cache_bvh_;
 
     const std::string intersect_shader_name_;
+    const IntersectorBackend backend_;
 
     std::array<float, APP_RAY_INTERSECTOR_RAYS_COUNT> distances;
+    float nearest_obstacle_distance_;
 
     friend class Gui; // access to private variables
 };
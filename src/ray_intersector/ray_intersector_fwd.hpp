@@ -0,0 +1,10 @@
+#pragma once
+
+namespace App {
+
+struct Ray;
+struct RayReadbackSlot;
+
+class RayIntersector;
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,188 @@
+#pragma once
+
+// STL
+#include <cmath>
+#include <cstdint>
+
+// Intrinsics
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Constants
+#include <constants/constants.hpp>
+
+/*
+    Thin wrapper over the widest instruction set the translation unit
+    is compiled for (AVX-512, AVX2 or plain scalar code), so SIMD kernels
+    are written once. WARNING: every instruction set lives in its own
+    inline namespace, so translation units compiled with different
+    flags don't break the one definition rule
+*/
+namespace App {
+
+namespace Simd {
+
+#if defined(__AVX512F__)
+
+inline namespace Avx512 {
+
+constexpr int APP_SIMD_WIDTH = 16;
+constexpr const char* APP_SIMD_NAME = "AVX-512";
+
+struct Float { __m512 value; };
+struct Mask { __mmask16 value; };
+
+inline Float Broadcast(const float value) { return Float{_mm512_set1_ps(value)}; }
+inline Float Load(const float* data) { return Float{_mm512_loadu_ps(data)}; }
+inline Float Gather(const float* data, const std::int32_t* indices) { return Float{_mm512_i32gather_ps(_mm512_loadu_si512(indices), data, 4)}; }
+inline void Store(float* data, const Float a) { _mm512_storeu_ps(data, a.value); }
+
+inline Float operator+(const Float a, const Float b) { return Float{_mm512_add_ps(a.value, b.value)}; }
+inline Float operator-(const Float a, const Float b) { return Float{_mm512_sub_ps(a.value, b.value)}; }
+inline Float operator*(const Float a, const Float b) { return Float{_mm512_mul_ps(a.value, b.value)}; }
+inline Float operator/(const Float a, const Float b) { return Float{_mm512_div_ps(a.value, b.value)}; }
+inline Float Min(const Float a, const Float b) { return Float{_mm512_min_ps(a.value, b.value)}; }
+inline Float Max(const Float a, const Float b) { return Float{_mm512_max_ps(a.value, b.value)}; }
+inline Float Abs(const Float a) { return Float{_mm512_abs_ps(a.value)}; }
+inline Float Sqrt(const Float a) { return Float{_mm512_sqrt_ps(a.value)}; }
+inline Float Round(const Float a) { return Float{_mm512_roundscale_ps(a.value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline Float Floor(const Float a) { return Float{_mm512_roundscale_ps(a.value, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)}; }
+
+inline Mask operator<(const Float a, const Float b) { return Mask{_mm512_cmp_ps_mask(a.value, b.value, _CMP_LT_OQ)}; }
+inline Mask operator<=(const Float a, const Float b) { return Mask{_mm512_cmp_ps_mask(a.value, b.value, _CMP_LE_OQ)}; }
+inline Mask operator>(const Float a, const Float b) { return Mask{_mm512_cmp_ps_mask(a.value, b.value, _CMP_GT_OQ)}; }
+inline Mask operator>=(const Float a, const Float b) { return Mask{_mm512_cmp_ps_mask(a.value, b.value, _CMP_GE_OQ)}; }
+inline Mask operator==(const Float a, const Float b) { return Mask{_mm512_cmp_ps_mask(a.value, b.value, _CMP_EQ_OQ)}; }
+inline Mask operator!=(const Float a, const Float b) { return Mask{_mm512_cmp_ps_mask(a.value, b.value, _CMP_NEQ_UQ)}; }
+
+inline Mask operator&(const Mask a, const Mask b) { return Mask{static_cast<__mmask16>(a.value & b.value)}; }
+inline Mask operator|(const Mask a, const Mask b) { return Mask{static_cast<__mmask16>(a.value | b.value)}; }
+inline Mask operator!(const Mask a) { return Mask{static_cast<__mmask16>(~a.value)}; }
+inline bool Any(const Mask a) { return a.value != 0; }
+
+// Takes b where mask is set and a elsewhere
+inline Float Select(const Mask mask, const Float a, const Float b) { return Float{_mm512_mask_blend_ps(mask.value, a.value, b.value)}; }
+
+// Every non-zero byte sets the lane
+inline Mask LoadMask(const std::uint8_t* data) {
+    __m512i lanes = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+    return Mask{_mm512_test_epi32_mask(lanes, lanes)};
+}
+
+inline void StoreMask(std::uint8_t* data, const Mask mask) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm512_cvtepi32_epi8(_mm512_maskz_set1_epi32(mask.value, 1)));
+}
+
+} // inline namespace Avx512
+
+#elif defined(__AVX2__)
+
+inline namespace Avx2 {
+
+constexpr int APP_SIMD_WIDTH = 8;
+constexpr const char* APP_SIMD_NAME = "AVX2";
+
+struct Float { __m256 value; };
+struct Mask { __m256 value; };
+
+inline Float Broadcast(const float value) { return Float{_mm256_set1_ps(value)}; }
+inline Float Load(const float* data) { return Float{_mm256_loadu_ps(data)}; }
+inline Float Gather(const float* data, const std::int32_t* indices) { return Float{_mm256_i32gather_ps(data, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)), 4)}; }
+inline void Store(float* data, const Float a) { _mm256_storeu_ps(data, a.value); }
+
+inline Float operator+(const Float a, const Float b) { return Float{_mm256_add_ps(a.value, b.value)}; }
+inline Float operator-(const Float a, const Float b) { return Float{_mm256_sub_ps(a.value, b.value)}; }
+inline Float operator*(const Float a, const Float b) { return Float{_mm256_mul_ps(a.value, b.value)}; }
+inline Float operator/(const Float a, const Float b) { return Float{_mm256_div_ps(a.value, b.value)}; }
+inline Float Min(const Float a, const Float b) { return Float{_mm256_min_ps(a.value, b.value)}; }
+inline Float Max(const Float a, const Float b) { return Float{_mm256_max_ps(a.value, b.value)}; }
+inline Float Abs(const Float a) { return Float{_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.value)}; }
+inline Float Sqrt(const Float a) { return Float{_mm256_sqrt_ps(a.value)}; }
+inline Float Round(const Float a) { return Float{_mm256_round_ps(a.value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline Float Floor(const Float a) { return Float{_mm256_floor_ps(a.value)}; }
+
+inline Mask operator<(const Float a, const Float b) { return Mask{_mm256_cmp_ps(a.value, b.value, _CMP_LT_OQ)}; }
+inline Mask operator<=(const Float a, const Float b) { return Mask{_mm256_cmp_ps(a.value, b.value, _CMP_LE_OQ)}; }
+inline Mask operator>(const Float a, const Float b) { return Mask{_mm256_cmp_ps(a.value, b.value, _CMP_GT_OQ)}; }
+inline Mask operator>=(const Float a, const Float b) { return Mask{_mm256_cmp_ps(a.value, b.value, _CMP_GE_OQ)}; }
+inline Mask operator==(const Float a, const Float b) { return Mask{_mm256_cmp_ps(a.value, b.value, _CMP_EQ_OQ)}; }
+inline Mask operator!=(const Float a, const Float b) { return Mask{_mm256_cmp_ps(a.value, b.value, _CMP_NEQ_UQ)}; }
+
+inline Mask operator&(const Mask a, const Mask b) { return Mask{_mm256_and_ps(a.value, b.value)}; }
+inline Mask operator|(const Mask a, const Mask b) { return Mask{_mm256_or_ps(a.value, b.value)}; }
+inline Mask operator!(const Mask a) { return Mask{_mm256_xor_ps(a.value, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))}; }
+inline bool Any(const Mask a) { return _mm256_movemask_ps(a.value) != 0; }
+
+// Takes b where mask is set and a elsewhere
+inline Float Select(const Mask mask, const Float a, const Float b) { return Float{_mm256_blendv_ps(a.value, b.value, mask.value)}; }
+
+// Every non-zero byte sets the lane
+inline Mask LoadMask(const std::uint8_t* data) {
+    __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)));
+    return Mask{_mm256_castsi256_ps(_mm256_cmpgt_epi32(lanes, _mm256_setzero_si256()))};
+}
+
+inline void StoreMask(std::uint8_t* data, const Mask mask) {
+    int bits = _mm256_movemask_ps(mask.value);
+    for (int lane = 0; lane < APP_SIMD_WIDTH; ++lane) {
+        data[lane] = (bits >> lane) & 1;
+    }
+}
+
+} // inline namespace Avx2
+
+#else
+
+inline namespace Scalar {
+
+constexpr int APP_SIMD_WIDTH = 1;
+constexpr const char* APP_SIMD_NAME = "scalar";
+
+struct Float { float value; };
+struct Mask { bool value; };
+
+inline Float Broadcast(const float value) { return Float{value}; }
+inline Float Load(const float* data) { return Float{*data}; }
+inline Float Gather(const float* data, const std::int32_t* indices) { return Float{data[*indices]}; }
+inline void Store(float* data, const Float a) { *data = a.value; }
+
+inline Float operator+(const Float a, const Float b) { return Float{a.value + b.value}; }
+inline Float operator-(const Float a, const Float b) { return Float{a.value - b.value}; }
+inline Float operator*(const Float a, const Float b) { return Float{a.value * b.value}; }
+inline Float operator/(const Float a, const Float b) { return Float{a.value / b.value}; }
+inline Float Min(const Float a, const Float b) { return Float{(b.value < a.value) ? b.value : a.value}; }
+inline Float Max(const Float a, const Float b) { return Float{(b.value > a.value) ? b.value : a.value}; }
+inline Float Abs(const Float a) { return Float{std::fabs(a.value)}; }
+inline Float Sqrt(const Float a) { return Float{std::sqrt(a.value)}; }
+inline Float Round(const Float a) { return Float{std::nearbyint(a.value)}; }
+inline Float Floor(const Float a) { return Float{std::floor(a.value)}; }
+
+inline Mask operator<(const Float a, const Float b) { return Mask{a.value < b.value}; }
+inline Mask operator<=(const Float a, const Float b) { return Mask{a.value <= b.value}; }
+inline Mask operator>(const Float a, const Float b) { return Mask{a.value > b.value}; }
+inline Mask operator>=(const Float a, const Float b) { return Mask{a.value >= b.value}; }
+inline Mask operator==(const Float a, const Float b) { return Mask{a.value == b.value}; }
+inline Mask operator!=(const Float a, const Float b) { return Mask{a.value != b.value}; }
+
+inline Mask operator&(const Mask a, const Mask b) { return Mask{a.value && b.value}; }
+inline Mask operator|(const Mask a, const Mask b) { return Mask{a.value || b.value}; }
+inline Mask operator!(const Mask a) { return Mask{!a.value}; }
+inline bool Any(const Mask a) { return a.value; }
+
+// Takes b where mask is set and a elsewhere
+inline Float Select(const Mask mask, const Float a, const Float b) { return mask.value ? b : a; }
+
+// Every non-zero byte sets the lane
+inline Mask LoadMask(const std::uint8_t* data) { return Mask{*data != 0}; }
+inline void StoreMask(std::uint8_t* data, const Mask mask) { *data = mask.value ? 1 : 0; }
+
+} // inline namespace Scalar
+
+#endif
+
+inline Float operator-(const Float a) { return Broadcast(0.0f) - a; }
+
+} // namespace Simd
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "sweep_and_prune.hpp"
+
+namespace App {
+
+// Extern variables
+/* empty */
+
+void SweepAndPrune::Update(const ObstacleBounds& obstacles, const ObstacleBounds& cars) {
+    if ((obstacles.GetSize() != obstacles_count_) || (cars.GetSize() != cars_count_)) {
+        Rebuild(obstacles, cars);
+        return;
+    }
+    for (int axis = 0; axis < AXES_COUNT; ++axis) {
+        RefreshValues(axis, obstacles, cars);
+        SortAxis(axis);
+    }
+}
+
+void SweepAndPrune::Clear() {
+    obstacles_count_ = 0;
+    cars_count_ = 0;
+    for (int axis = 0; axis < AXES_COUNT; ++axis) {
+        endpoints_[axis].clear();
+    }
+    pair_states_.clear();
+    pairs_.clear();
+}
+
+void SweepAndPrune::Rebuild(const ObstacleBounds& obstacles, const ObstacleBounds& cars) {
+    obstacles_count_ = obstacles.GetSize();
+    cars_count_ = cars.GetSize();
+    const std::uint32_t boxes_count = static_cast<std::uint32_t>(obstacles_count_ + cars_count_);
+
+    pair_states_.clear();
+    pairs_.clear();
+
+    // Boxes whose min endpoint was passed but the max one wasn't yet, split by kind
+    std::vector<std::uint32_t> active_boxes[2];
+    std::vector<int> active_positions(boxes_count);
+
+    for (int axis = 0; axis < AXES_COUNT; ++axis) {
+        auto& endpoints = endpoints_[axis];
+        endpoints.resize(2 * boxes_count);
+        for (std::uint32_t box = 0; box < boxes_count; ++box) {
+            endpoints[2 * box] = SweepEndpoint{0.0f, box << 1};
+            endpoints[2 * box + 1] = SweepEndpoint{0.0f, (box << 1) | 1u};
+        }
+        RefreshValues(axis, obstacles, cars);
+        std::sort(endpoints.begin(), endpoints.end(), IsLess);
+
+        for (const auto& endpoint : endpoints) {
+            std::uint32_t box = GetBox(endpoint);
+            int kind = (box < static_cast<std::uint32_t>(obstacles_count_)) ? 0 : 1;
+            auto& same_kind_boxes = active_boxes[kind];
+
+            if (!IsMax(endpoint)) {
+                for (auto other_box : active_boxes[1 - kind]) {
+                    SetOverlap(box, other_box, axis, true);
+                }
+                active_positions[box] = static_cast<int>(same_kind_boxes.size());
+                same_kind_boxes.push_back(box);
+            } else {
+                int position = active_positions[box];
+                same_kind_boxes[position] = same_kind_boxes.back();
+                active_positions[same_kind_boxes[position]] = position;
+                same_kind_boxes.pop_back();
+            }
+        }
+    }
+}
+
+void SweepAndPrune::RefreshValues(const int axis, const ObstacleBounds& obstacles, const ObstacleBounds& cars) {
+    const float* obstacles_min = (axis == 0) ? obstacles.min_x.data() : obstacles.min_z.data();
+    const float* obstacles_max = (axis == 0) ? obstacles.max_x.data() : obstacles.max_z.data();
+    const float* cars_min = (axis == 0) ? cars.min_x.data() : cars.min_z.data();
+    const float* cars_max = (axis == 0) ? cars.max_x.data() : cars.max_z.data();
+
+    for (auto& endpoint : endpoints_[axis]) {
+        std::uint32_t box = GetBox(endpoint);
+        if (box < static_cast<std::uint32_t>(obstacles_count_)) {
+            endpoint.value = IsMax(endpoint) ? obstacles_max[box] : obstacles_min[box];
+        } else {
+            box -= static_cast<std::uint32_t>(obstacles_count_);
+            endpoint.value = IsMax(endpoint) ? cars_max[box] : cars_min[box];
+        }
+    }
+}
+
+void SweepAndPrune::SortAxis(const int axis) {
+    auto& endpoints = endpoints_[axis];
+    for (size_t index = 1; index < endpoints.size(); ++index) {
+        SweepEndpoint endpoint = endpoints[index];
+        size_t position = index;
+        while ((position > 0) && IsLess(endpoint, endpoints[position - 1])) {
+            const SweepEndpoint& passed = endpoints[position - 1];
+            // Min passing a max to the left starts the overlap, max passing a min ends it
+            if (IsMax(endpoint) != IsMax(passed)) {
+                SetOverlap(GetBox(endpoint), GetBox(passed), axis, !IsMax(endpoint));
+            }
+            endpoints[position] = passed;
+            --position;
+        }
+        endpoints[position] = endpoint;
+    }
+}
+
+void SweepAndPrune::SetOverlap(const std::uint32_t first_box, const std::uint32_t second_box, const int axis, const bool overlap) {
+    const std::uint32_t obstacles_count = static_cast<std::uint32_t>(obstacles_count_);
+    if ((first_box < obstacles_count) == (second_box < obstacles_count)) {
+        return;
+    }
+    std::uint32_t obstacle_index = (std::min)(first_box, second_box);
+    std::uint32_t car_index = (std::max)(first_box, second_box) - obstacles_count;
+    std::uint64_t key = GetPairKey(obstacle_index, car_index);
+
+    // Overlap may only end for the pairs already stored, so the lookup doesn't insert in that case
+    auto state_it = pair_states_.find(key);
+    if (state_it == pair_states_.end()) {
+        if (!overlap) {
+            return;
+        }
+        state_it = pair_states_.emplace(key, PairState{}).first;
+    }
+    PairState& state = state_it->second;
+
+    constexpr std::uint8_t all_axes = (1u << AXES_COUNT) - 1u;
+    std::uint8_t old_axes = state.overlap_axes;
+    std::uint8_t new_axes = overlap ? (old_axes | (1u << axis)) : (old_axes & ~(1u << axis));
+    state.overlap_axes = new_axes;
+
+    if ((new_axes == all_axes) && (old_axes != all_axes)) {
+        state.pair_position = static_cast<int>(pairs_.size());
+        pairs_.push_back(SweepPair{static_cast<int>(obstacle_index), static_cast<int>(car_index)});
+    } else if ((old_axes == all_axes) && (new_axes != all_axes)) {
+        int position = state.pair_position;
+        SweepPair last_pair = pairs_.back();
+        pairs_[position] = last_pair;
+        pair_states_[GetPairKey(last_pair.obstacle_index, last_pair.car_index)].pair_position = position;
+        pairs_.pop_back();
+        state.pair_position = -1;
+    }
+    if (new_axes == 0) {
+        pair_states_.erase(key);
+    }
+}
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+// STL
+#define NOMINMAX
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <sweep_and_prune/sweep_and_prune_fwd.hpp>
+
+// LibSmartCar
+#include <bvh/bvh.hpp>
+
+namespace App {
+
+// Box index is stored in the upper bits, the lowest bit is set for the max endpoint
+struct SweepEndpoint {
+    float value;
+    std::uint32_t box_and_side;
+};
+static_assert(sizeof(SweepEndpoint) == 8);
+
+struct SweepPair {
+    int obstacle_index;
+    int car_index;
+};
+
+/*
+    Sweep and prune broadphase on the ground plane axes (X and Z).
+    Endpoints of every axis are kept sorted between the calls: the car moves a little each tick,
+    so insertion sort runs in almost linear time and every swap of a min and a max endpoint
+    starts or ends the overlap of the two boxes on that axis. Overlaps of obstacles with each other
+    and of cars with each other are not tracked
+*/
+class SweepAndPrune {
+public:
+    // Obstacles are boxes [0, obstacles_count), cars follow them. Endpoints are rebuilt only when the counts change
+    void Update(const ObstacleBounds& obstacles, const ObstacleBounds& cars);
+    void Clear();
+
+    // Pairs overlapping on both axes in no particular order, the vertical axis is left to the narrowphase
+    const std::vector<SweepPair>& GetPairs() const { return pairs_; }
+
+private:
+    static constexpr int AXES_COUNT = 2;
+
+    void Rebuild(const ObstacleBounds& obstacles, const ObstacleBounds& cars);
+    void RefreshValues(const int axis, const ObstacleBounds& obstacles, const ObstacleBounds& cars);
+    void SortAxis(const int axis);
+    void SetOverlap(const std::uint32_t first_box, const std::uint32_t second_box, const int axis, const bool overlap);
+
+    static bool IsMax(const SweepEndpoint& endpoint) { return (endpoint.box_and_side & 1u) != 0; }
+    static std::uint32_t GetBox(const SweepEndpoint& endpoint) { return endpoint.box_and_side >> 1; }
+
+    // Min endpoint goes first on ties, so touching boxes overlap as in the other backends
+    static bool IsLess(const SweepEndpoint& lhs, const SweepEndpoint& rhs) {
+        return (lhs.value < rhs.value) || ((lhs.value == rhs.value) && !IsMax(lhs) && IsMax(rhs));
+    }
+
+    // Bit per overlapping axis and position in pairs_ (-1 if not there)
+    struct PairState {
+        std::uint8_t overlap_axes = 0;
+        int pair_position = -1;
+    };
+
+    // Car index in the upper half, obstacle index in the lower one
+    static std::uint64_t GetPairKey(const std::uint32_t obstacle_index, const std::uint32_t car_index) {
+        return (static_cast<std::uint64_t>(car_index) << 32) | obstacle_index;
+    }
+
+    size_t obstacles_count_ = 0;
+    size_t cars_count_ = 0;
+    std::vector<SweepEndpoint> endpoints_[AXES_COUNT];
+
+    // Only pairs overlapping on at least one axis are stored, so memory doesn't grow with obstacles * cars
+    std::unordered_map<std::uint64_t, PairState> pair_states_;
+    std::vector<SweepPair> pairs_;
+};
+
+} // namespace App
\ No newline at end of file
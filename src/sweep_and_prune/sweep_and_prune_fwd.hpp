@@ -0,0 +1,10 @@
+#pragma once
+
+namespace App {
+
+struct SweepEndpoint;
+struct SweepPair;
+
+class SweepAndPrune;
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "triangle_bvh.hpp"
+
+namespace App {
+
+TriangleBvh::TriangleBvh(const std::vector<GL::Vertex>& vertices, const std::vector<int>& indices) {
+    const size_t triangles_count = indices.size() / 3;
+    triangles_.reserve(triangles_count);
+
+    ObstacleBounds triangle_bounds;
+    for (size_t triangle_index = 0; triangle_index < triangles_count; ++triangle_index) {
+        const GL::Vec3& a = vertices[indices[3 * triangle_index + 0]].Pos;
+        const GL::Vec3& b = vertices[indices[3 * triangle_index + 1]].Pos;
+        const GL::Vec3& c = vertices[indices[3 * triangle_index + 2]].Pos;
+
+        triangles_.push_back(MeshTriangle{
+            {a.X, a.Y, a.Z},
+            {b.X - a.X, b.Y - a.Y, b.Z - a.Z},
+            {c.X - a.X, c.Y - a.Y, c.Z - a.Z}
+        });
+        triangle_bounds.Add(
+            GL::Vec3{(std::min)({a.X, b.X, c.X}), (std::min)({a.Y, b.Y, c.Y}), (std::min)({a.Z, b.Z, c.Z})},
+            GL::Vec3{(std::max)({a.X, b.X, c.X}), (std::max)({a.Y, b.Y, c.Y}), (std::max)({a.Z, b.Z, c.Z})}
+        );
+    }
+    bvh_.Build(triangle_bounds);
+}
+
+float TriangleBvh::IntersectRay(const GL::Vec3& origin, const GL::Vec3& direction, const float max_distance) const {
+    return bvh_.IntersectRay(origin, direction, [this, &origin, &direction](const int triangle_index, const float, const float) {
+        return IntersectTriangle(triangle_index, origin, direction);
+    }, max_distance);
+}
+
+// Moller-Trumbore, returns infinity if the triangle is missed
+float TriangleBvh::IntersectTriangle(const int triangle_index, const GL::Vec3& origin, const GL::Vec3& direction) const {
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    constexpr float min_abs_determinant = 1e-20f;
+
+    const MeshTriangle& triangle = triangles_[triangle_index];
+    const float* e1 = triangle.edge_1;
+    const float* e2 = triangle.edge_2;
+
+    float p[3] = {
+        direction.Y * e2[2] - direction.Z * e2[1],
+        direction.Z * e2[0] - direction.X * e2[2],
+        direction.X * e2[1] - direction.Y * e2[0]
+    };
+    float determinant = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+
+    // Ray is parallel to the triangle plane
+    if (std::fabs(determinant) < min_abs_determinant) {
+        return infinity;
+    }
+    float inverse_determinant = 1.0f / determinant;
+
+    float s[3] = {origin.X - triangle.vertex[0], origin.Y - triangle.vertex[1], origin.Z - triangle.vertex[2]};
+    float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse_determinant;
+    if ((u < 0.0f) || (u > 1.0f)) {
+        return infinity;
+    }
+
+    float q[3] = {
+        s[1] * e1[2] - s[2] * e1[1],
+        s[2] * e1[0] - s[0] * e1[2],
+        s[0] * e1[1] - s[1] * e1[0]
+    };
+    float v = (direction.X * q[0] + direction.Y * q[1] + direction.Z * q[2]) * inverse_determinant;
+    if ((v < 0.0f) || (u + v > 1.0f)) {
+        return infinity;
+    }
+
+    float t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inverse_determinant;
+    return (t > 0.0f) ? t : infinity;
+}
+
+} // namespace App
\ No newline at end of file
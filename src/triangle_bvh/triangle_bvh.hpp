@@ -0,0 +1,65 @@
+#pragma once
+
+// STL
+#define NOMINMAX
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// OpenGL Wrapper
+#include <GL/OOGL.hpp>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <triangle_bvh/triangle_bvh_fwd.hpp>
+
+// LibSmartCar
+#include <bvh/bvh.hpp>
+
+namespace App {
+
+// First vertex and two edges, so the ray test doesn't recompute them
+struct MeshTriangle {
+    float vertex[3];
+    float edge_1[3];
+    float edge_2[3];
+};
+static_assert(sizeof(MeshTriangle) == 36);
+
+/*
+    Triangles of a single mesh in mesh space with the BVH over them.
+    Built once when the mesh is loaded and shared by all the copies of the mesh
+*/
+class TriangleBvh {
+public:
+    // Every three indices make a triangle, as after aiProcess_Triangulate
+    TriangleBvh(const std::vector<GL::Vertex>& vertices, const std::vector<int>& indices);
+
+    bool IsEmpty() const { return triangles_.empty(); }
+    size_t GetTrianglesCount() const { return triangles_.size(); }
+
+    /*
+        Nearest triangle hit with 0 < t < max_distance (infinity otherwise), triangles are double-sided.
+        Direction doesn't have to be normalized, t is measured in its lengths
+    */
+    float IntersectRay(const GL::Vec3& origin, const GL::Vec3& direction,
+        const float max_distance = std::numeric_limits<float>::infinity()) const;
+
+private:
+    float IntersectTriangle(const int triangle_index, const GL::Vec3& origin, const GL::Vec3& direction) const;
+
+    std::vector<MeshTriangle> triangles_;
+    Bvh bvh_;
+};
+
+// Mesh triangles placed into the world
+struct TriangleBvhInstance {
+    std::shared_ptr<const TriangleBvh> bvh;
+    GL::Mat4 mesh_to_world;
+};
+
+} // namespace App
\ No newline at end of file
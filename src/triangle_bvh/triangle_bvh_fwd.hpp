@@ -0,0 +1,10 @@
+#pragma once
+
+namespace App {
+
+struct MeshTriangle;
+struct TriangleBvhInstance;
+
+class TriangleBvh;
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "world.hpp"
+
+// Incomplete type resolve
+#include <car_model/car_model.hpp>
+
+namespace App {
+
+// Extern variables
+/* empty */
+
+World::World()
+    : car_model(nullptr), obstacles({}), obstacle_registry(std::make_shared<ObstacleRegistry>()), nearest_obstacle_distance(std::numeric_limits<float>::infinity()) {
+    distances_from_rays.fill(0.0f);
+    state.fill(0.0f);
+    actions.fill(false);
+    user_selected_actions.fill(false);
+}
+
+void World::Step(float delta_time, const bool update_rays) {
+    car_model->Move(actions, delta_time, update_rays);
+    if (update_rays) {
+        distances_from_rays = car_model->GetRayIntersector()->GetResultDistances();
+        nearest_obstacle_distance = car_model->GetRayIntersector()->GetNearestObstacleDistance();
+    }
+}
+
+void World::ClearCarTransform() {
+    car_model->SetState(CarState{});
+}
+
+} // namespace App
\ No newline at end of file
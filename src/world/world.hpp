@@ -0,0 +1,60 @@
+#pragma once
+
+// STL
+#include <array>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Constants
+#include <constants/constants.hpp>
+
+// Forward declarations
+#include <world/world_fwd.hpp>
+
+// LibSmartCar
+#include <helpers/helpers.hpp>
+#include <model/model.hpp>
+#include <obstacle_registry/obstacle_registry.hpp>
+
+// Incomplete type resolve
+#include <car_model/car_model_fwd.hpp>
+
+namespace App {
+
+/*
+    Simulation state of one car and its obstacles.
+    Unlike Context (window, GL context, shaders, camera and other
+    rendering resources) it is not a singleton, so several worlds
+    can live side by side and be stepped independently
+*/
+struct World {
+public:
+    World();
+
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    std::shared_ptr<CarModel> car_model;
+    std::vector<std::shared_ptr<Model>> obstacles;
+
+    // Boxes of the obstacles above, shared by the car sensors
+    std::shared_ptr<ObstacleRegistry> obstacle_registry;
+
+    // INPUT TO NEURAL NETWORK
+    std::array<float, APP_RAY_INTERSECTOR_RAYS_COUNT> distances_from_rays;
+    std::array<float, APP_CAR_STATE_PARAMETERS_COUNT> state;
+
+    // Distance to the closest obstacle (GRID ray intersector with the distance field only)
+    float nearest_obstacle_distance;
+
+    // OUTPUT FROM NEURAL NETWORK
+    CarActions actions;
+    CarActions user_selected_actions; // TODO: for supervides learning (should get rid of it)
+
+    // Applies current actions to the car and updates distances from rays (unless they are sensed by the caller)
+    void Step(float delta_time, const bool update_rays = true);
+    void ClearCarTransform();
+};
+
+} // namespace App
\ No newline at end of file
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace App {
+
+struct World;
+
+} // namespace App
\ No newline at end of file